@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_ASSOCIATED_IMMEDIACY_HPP
+#define ASIOEX_ASSOCIATED_IMMEDIACY_HPP
+
+#include <type_traits>
+#include <utility>
+
+namespace asioex
+{
+
+/// Trait which yields whether a handler accepts inline completion.
+/// Handlers with a `get_immediacy()` member use it, all others are posted.
+/// Handler adapters forward it, so that it survives being wrapped.
+template <typename T, typename = void>
+struct associated_immediacy
+{
+    static bool get(const T &) noexcept { return false; }
+};
+
+template <typename T>
+struct associated_immediacy<
+    T, std::void_t<decltype(std::declval<const T &>().get_immediacy())>>
+{
+    static bool get(const T & t) noexcept
+    {
+        return t.get_immediacy();
+    }
+};
+
+template <typename T>
+inline bool get_associated_immediacy(const T & t) noexcept
+{
+    return associated_immediacy<T>::get(t);
+}
+
+}   // namespace asioex
+
+#endif   // ASIOEX_ASSOCIATED_IMMEDIACY_HPP
@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_ASYNC_BARRIER_HPP
+#define ASIOEX_ASYNC_BARRIER_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace asioex
+{
+struct async_barrier_base;
+
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+
+/// @brief The phase completion function of a barrier which has none.
+struct empty_phase_completion
+{
+    void
+    operator()() noexcept
+    {
+    }
+};
+}   // namespace detail
+
+/// @brief The executor-independent part of basic_async_barrier.
+struct async_barrier_base
+{
+    inline explicit async_barrier_base(std::ptrdiff_t expected);
+
+    async_barrier_base(async_barrier_base const &) ASIO_DELETED;
+
+    async_barrier_base &
+    operator=(async_barrier_base const &) ASIO_DELETED;
+
+    inline ~async_barrier_base();
+
+    /// @brief The number of arrivals which complete each phase.
+    ASIO_NODISCARD inline std::ptrdiff_t
+    expected() const noexcept;
+
+    /// @brief The number of arrivals still needed to complete the current
+    /// phase.
+    ASIO_NODISCARD inline std::ptrdiff_t
+    pending() const noexcept;
+
+    /// @brief The number of phases completed so far.
+    ASIO_NODISCARD inline std::uint64_t
+    phase() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< async_barrier_base >;
+
+    /// @brief Count n arrivals at the current phase.
+    /// @returns true if they complete the phase, in which case the caller
+    /// must run the phase completion function and then finish_phase.
+    inline bool
+    count_arrival(std::ptrdiff_t n);
+
+    /// @brief Remove one participant from every later phase.
+    inline void
+    drop();
+
+    /// @brief Start the next phase and complete the waiters of this one.
+    inline void
+    finish_phase();
+
+    inline void
+    add_waiter(wait_op *waiter);
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    detail::sized_bilist waiters_;
+    std::ptrdiff_t       expected_;
+    std::ptrdiff_t       pending_;
+    std::uint64_t        phase_;
+    wait_op_pool_stats   pool_stats_;
+};
+
+/// @brief An asynchronous reusable barrier.
+/// @details Each phase completes once the expected number of participants
+/// have arrived. The last arrival runs the phase completion function and
+/// then every participant which arrived and waited resumes, in one batch per
+/// associated executor. The barrier then starts the next phase with the same
+/// number of participants, less those which left with arrive_and_drop.
+///
+/// Cancelling an async_arrive_and_wait completes it with
+/// error::operation_aborted, but its arrival still counts towards the phase.
+///
+/// Like basic_async_semaphore, this object is not thread-safe.
+/// @tparam CompletionFunction is invoked with no arguments when each phase
+/// completes, before any participant resumes. It must not throw.
+template < class Executor           = asio::any_io_executor,
+           class CompletionFunction = detail::empty_phase_completion >
+struct basic_async_barrier : async_barrier_base
+{
+    static_assert(std::is_nothrow_invocable_v< CompletionFunction & >,
+                  "the phase completion function must not throw");
+
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// Rebinds the barrier type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The barrier type when rebound to the specified executor.
+        typedef basic_async_barrier< Executor1, CompletionFunction > other;
+    };
+
+    /// @brief Construct an async_barrier
+    /// @param exec is the default executor associated with the barrier
+    /// @param expected is the number of participants in each phase.
+    /// @param completion is invoked each time a phase completes.
+    /// @pre expected > 0
+    basic_async_barrier(executor_type      exec,
+                        std::ptrdiff_t     expected,
+                        CompletionFunction completion = CompletionFunction());
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Arrive at the current phase n times without waiting for it to
+    /// complete.
+    /// @pre 0 < n <= pending()
+    void
+    arrive(std::ptrdiff_t n = 1);
+
+    /// @brief Arrive at the current phase and take no part in later ones.
+    void
+    arrive_and_drop();
+
+    /// @brief Arrive at the current phase and wait for it to complete.
+    /// @details If this is the last arrival the phase completes at once, and
+    /// so does this operation.
+    /// @note The completion handler will be invoked as if by `post` to the
+    /// handler's associated executor, or `dispatch` for tokens adapted with
+    /// asioex::immediate when this arrival completes the phase.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_arrive_and_wait(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    void
+    complete_phase();
+
+    executor_type      exec_;
+    CompletionFunction completion_;
+};
+
+using async_barrier = basic_async_barrier<>;
+
+}   // namespace asioex
+
+#endif
+
+#include <asioex/impl/async_barrier_base.hpp>
+#include <asioex/impl/basic_async_barrier.hpp>
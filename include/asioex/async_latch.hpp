@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_ASYNC_LATCH_HPP
+#define ASIOEX_ASYNC_LATCH_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+
+#include <cstddef>
+
+namespace asioex
+{
+struct async_latch_base;
+
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+}   // namespace detail
+
+/// @brief The executor-independent part of basic_async_latch.
+struct async_latch_base
+{
+    inline explicit async_latch_base(std::ptrdiff_t expected);
+
+    async_latch_base(async_latch_base const &) ASIO_DELETED;
+
+    async_latch_base &
+    operator=(async_latch_base const &) ASIO_DELETED;
+
+    inline ~async_latch_base();
+
+    /// @brief Decrement the counter by n.
+    /// @details When the counter reaches zero every pending async_wait
+    /// commences completion. Completions which share an associated executor
+    /// are delivered by a single posted work item.
+    /// @pre 0 <= n <= value()
+    inline void
+    count_down(std::ptrdiff_t n = 1);
+
+    /// @brief Whether the counter has reached zero.
+    ASIO_NODISCARD inline bool
+    try_wait() const noexcept;
+
+    /// @brief The current value of the counter.
+    ASIO_NODISCARD inline std::ptrdiff_t
+    value() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< async_latch_base >;
+
+    inline void
+    add_waiter(wait_op *waiter);
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    detail::sized_bilist waiters_;
+    std::ptrdiff_t       count_;
+    wait_op_pool_stats   pool_stats_;
+};
+
+/// @brief An asynchronous single-use countdown latch.
+/// @details The latch is created with a count, which is decremented by
+/// count_down. async_wait completes once the count is zero. Joining N
+/// concurrent children costs one count_down per child and a single wait op
+/// for the parent.
+///
+/// Like basic_async_semaphore, this object is not thread-safe.
+template < class Executor = asio::any_io_executor >
+struct basic_async_latch : async_latch_base
+{
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// Rebinds the latch type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The latch type when rebound to the specified executor.
+        typedef basic_async_latch< Executor1 > other;
+    };
+
+    /// @brief Construct an async_latch
+    /// @param exec is the default executor associated with the latch
+    /// @param expected is the initial value of the counter.
+    /// @pre expected >= 0
+    basic_async_latch(executor_type exec, std::ptrdiff_t expected);
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Initiate an asynchronous wait for the counter to reach zero.
+    /// @details If the counter is already zero the operation completes
+    /// without waiting. If the latch is destroyed or the operation is
+    /// cancelled first, it completes with error::operation_aborted.
+    /// @note The completion handler will be invoked as if by `post` to the
+    /// handler's associated executor, or `dispatch` for tokens adapted with
+    /// asioex::immediate when the counter is already zero.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_wait(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    executor_type exec_;
+};
+
+using async_latch = basic_async_latch<>;
+
+}   // namespace asioex
+
+#endif
+
+#include <asioex/impl/async_latch_base.hpp>
+#include <asioex/impl/basic_async_latch.hpp>
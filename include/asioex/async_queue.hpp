@@ -0,0 +1,330 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_ASYNC_QUEUE_HPP
+#define ASIOEX_ASYNC_QUEUE_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/expanding_circular_buffer.hpp>
+#include <asioex/detail/queue_wait_handler.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+#include <asioex/weight.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+
+namespace asioex
+{
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+}   // namespace detail
+
+/// @brief The executor-independent part of basic_async_queue.
+template < class T, class Weight = unit_weight >
+struct async_queue_base
+{
+    inline async_queue_base(std::size_t capacity, Weight weight);
+
+    async_queue_base(async_queue_base const &) ASIO_DELETED;
+
+    async_queue_base &
+    operator=(async_queue_base const &) ASIO_DELETED;
+
+    inline ~async_queue_base();
+
+    /// @brief Push value if there is room for it now.
+    /// @details Fails if the queue is closed, if there is not enough room, or
+    /// if an async_push is already waiting, so that it is not overtaken.
+    /// @returns true if value was pushed. value is only moved from if so.
+    inline bool
+    try_push(T &&value);
+
+    /// @brief Pop the front item into value if there is one.
+    /// @returns true if an item was popped.
+    inline bool
+    try_pop(T &value);
+
+    /// @brief Pop as many items as are available, up to out.size(), into
+    /// out.
+    /// @returns The number of items popped.
+    inline std::size_t
+    try_pop_some(std::span< T > out);
+
+    /// @brief Close the queue.
+    /// @details Pending and future pushes fail with error::broken_pipe, and
+    /// pending pops fail with error::eof. Items already in the queue can
+    /// still be popped, after which pops fail with error::eof.
+    inline void
+    close();
+
+    /// @brief Whether the queue has not been closed.
+    ASIO_NODISCARD inline bool
+    is_open() const noexcept;
+
+    /// @brief The number of items in the queue.
+    ASIO_NODISCARD inline std::size_t
+    size() const noexcept;
+
+    /// @brief The total weight of the items in the queue.
+    ASIO_NODISCARD inline std::size_t
+    used() const noexcept;
+
+    /// @brief The maximum total weight of the items in the queue.
+    ASIO_NODISCARD inline std::size_t
+    capacity() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< async_queue_base >;
+
+    /// @brief Which list a wait op is queued on, stored in the op's
+    /// requested_ member.
+    enum waiter_kind : int
+    {
+        push_waiter,
+        pop_waiter
+    };
+
+    /// @brief A parked push, which holds the value to be pushed.
+    struct push_action
+    {
+        bool
+        ready()
+        {
+            return queue_->admit(value_);
+        }
+
+        template < class Handler >
+        void
+        complete(Handler &&handler, error_code ec)
+        {
+            std::move(handler)(ec);
+        }
+
+        async_queue_base *queue_;
+        T                 value_;
+    };
+
+    /// @brief A parked pop, which receives the item popped for it.
+    struct pop_action
+    {
+        bool
+        ready()
+        {
+            value_.emplace(queue_->take());
+            return true;
+        }
+
+        template < class Handler >
+        void
+        complete(Handler &&handler, error_code ec)
+        {
+            if (value_)
+                std::move(handler)(ec, std::move(*value_));
+            else
+                std::move(handler)(ec, T());
+        }
+
+        async_queue_base  *queue_;
+        std::optional< T > value_ = std::nullopt;
+    };
+
+    /// @brief A parked batch pop, which receives the number of items popped
+    /// into its span.
+    struct pop_some_action
+    {
+        bool
+        ready()
+        {
+            count_ = queue_->take_some(out_);
+            return true;
+        }
+
+        template < class Handler >
+        void
+        complete(Handler &&handler, error_code ec)
+        {
+            std::move(handler)(ec, count_);
+        }
+
+        async_queue_base *queue_;
+        std::span< T >    out_;
+        std::size_t       count_ = 0;
+    };
+
+    inline void
+    add_waiter(wait_op *waiter);
+
+    /// @brief Move value into the queue if it fits.
+    inline bool
+    admit(T &value);
+
+    /// @brief Remove and return the front item.
+    /// @pre size() > 0
+    inline T
+    take();
+
+    /// @brief Move up to out.size() items from the front into out.
+    inline std::size_t
+    take_some(std::span< T > out);
+
+    /// @brief Resume as many waiters as the queue's contents now allow.
+    inline void
+    notify();
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    inline std::size_t
+    weigh(T const &value) const;
+
+    detail::expanding_circular_buffer< T > items_;
+    std::size_t                            capacity_;
+    std::size_t                            used_;
+    bool                                   closed_;
+    detail::sized_bilist                   pushers_;
+    detail::sized_bilist                   poppers_;
+    wait_op_pool_stats                     pool_stats_;
+    [[no_unique_address]] Weight           weight_;
+};
+
+/// @brief A bounded asynchronous queue with backpressure.
+/// @details Any number of producers push and any number of consumers pop.
+/// Once the total weight of the queued items reaches the capacity, further
+/// pushes wait for room, and pops wait while the queue is empty. Both are
+/// served in arrival order. The capacity counts items by default. With
+/// byte_weight, or any other Weight, it counts that instead. An item heavier
+/// than the whole capacity is weighed as the capacity, so it is admitted
+/// into an otherwise empty queue.
+///
+/// try_push, try_pop and try_pop_some never wait and never post.
+///
+/// Items are handed over at the moment a waiter is resumed. A completion
+/// which was cancelled or aborted never holds an item, and the queue may be
+/// destroyed with completions still in flight.
+///
+/// Like basic_async_semaphore, this object is not thread-safe.
+/// @tparam T is the item type. It must be move constructible and move
+/// assignable. async_pop additionally requires it to be default
+/// constructible, to report errors.
+template < class T,
+           class Executor = asio::any_io_executor,
+           class Weight   = unit_weight >
+struct basic_async_queue : async_queue_base< T, Weight >
+{
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// @brief The type of the items.
+    using value_type = T;
+
+    /// Rebinds the queue type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The queue type when rebound to the specified executor.
+        typedef basic_async_queue< T, Executor1, Weight > other;
+    };
+
+    /// @brief Construct an async_queue
+    /// @param exec is the default executor associated with the queue
+    /// @param capacity is the maximum total weight of the queued items.
+    /// @param weight weighs each item.
+    /// @pre capacity > 0
+    basic_async_queue(executor_type exec,
+                      std::size_t   capacity,
+                      Weight        weight = Weight());
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Initiate an asynchronous push of value.
+    /// @details Completes once value is in the queue, or with
+    /// error::broken_pipe if the queue is or becomes closed first. If the
+    /// operation fails value is discarded.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_push(T value,
+               CompletionToken &&token
+                   ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Initiate an asynchronous pop of the front item.
+    /// @details Completes with the item, or with error::eof once the queue
+    /// is closed and empty.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, T)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, T))
+    async_pop(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Initiate an asynchronous pop of between 1 and out.size() items
+    /// into out.
+    /// @details Waits only while the queue is empty, and then takes every
+    /// item available which fits. Completes with the number of items popped,
+    /// or with error::eof once the queue is closed and empty.
+    /// @note out must remain valid until the operation completes.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, std::size_t))
+                   CompletionToken
+                       ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, std::size_t))
+    async_pop_some(std::span< T > out,
+                   CompletionToken &&token
+                       ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    using base_type = async_queue_base< T, Weight >;
+
+    template < class Action, class AssociatedExecutor, class Handler >
+    void
+    park(typename base_type::waiter_kind kind,
+         Action                        &&action,
+         AssociatedExecutor              e,
+         Handler                       &&handler);
+
+    executor_type exec_;
+};
+
+template < class T >
+using async_queue = basic_async_queue< T >;
+
+}   // namespace asioex
+
+#endif
+
+#include <asioex/impl/async_queue_base.hpp>
+#include <asioex/impl/basic_async_queue.hpp>
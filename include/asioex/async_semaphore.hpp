@@ -4,15 +4,37 @@
 #include <asio/any_io_executor.hpp>
 #include <asio/async_result.hpp>
 #include <asio/detail/config.hpp>
-#include <asioex/detail/bilist_node.hpp>
+#include <asioex/detail/semaphore_deadline_timer.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
 #include <asioex/error_code.hpp>
+#include <asioex/sync_stats.hpp>
+#include <asioex/wait_queue_policy.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
 
 namespace asioex
 {
+struct async_semaphore_base;
+
 namespace detail
 {
-struct semaphore_wait_op;
-}
+template < class Host >
+struct basic_semaphore_wait_op;
+
+using semaphore_wait_op = basic_semaphore_wait_op< async_semaphore_base >;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+
+template < class Op >
+struct semaphore_deadline_link;
+}   // namespace detail
 
 struct async_semaphore_base
 {
@@ -32,56 +54,150 @@ struct async_semaphore_base
 
     /// @brief Attempt to immediately acquire the semaphore.
     /// @details This function attempts to acquire the semaphore without
-    /// blocking or initiating an asynchronous operation.
+    /// blocking or initiating an asynchronous operation. The attempt fails if
+    /// there are pending async_acquire operations, so that they are not
+    /// overtaken.
+    /// @param n is the number of units to acquire.
     /// @returns true if the semaphore was acquired, false otherwise
     inline bool
-    try_acquire();
+    try_acquire(int n = 1);
 
     /// @brief Release the sempahore.
-    /// @details This function immediately releases the semaphore. If there are
-    /// pending async_acquire operations, then the least recent operation will
-    /// commence completion.
+    /// @details This function immediately releases n units. Pending
+    /// async_acquire operations are completed in queue order for as long as
+    /// the count satisfies the one at the head. A large request at the head of
+    /// the queue is never overtaken by smaller ones behind it.
+    /// @see fifo_wait_queue, lifo_wait_queue, priority_wait_queue
+    /// @param n is the number of units to release.
     inline void
-    release();
+    release(int n = 1);
 
     /// @brief Release the sempahore to achieve a value of zero.
-    /// @returns The amount of releases.
-    /// @details This function immediately releases the semaphore. If there are
-    /// pending async_acquire operations, then the least recent operation will
-    /// commence completion.
+    /// @returns The number of units released.
+    /// @details This function releases exactly enough units to satisfy every
+    /// pending async_acquire operation, all of which commence completion. The
+    /// count is left at zero. Completions which share an associated executor
+    /// are delivered by a single posted work item, in queue order. If there
+    /// are no pending operations this function has no effect.
     inline std::size_t
     release_all();
 
+    /// @brief The count less the units requested by pending async_acquire
+    /// operations.
+    /// @details This is a constant time operation.
     ASIO_NODISCARD inline int
     value() const noexcept;
 
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    /// @details Only contended acquires allocate a wait op. Handlers with an
+    /// associated allocator other than std::allocator always count as misses.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+    /// @brief The number of pending async_acquire operations.
+    ASIO_NODISCARD inline std::size_t
+    waiters() const noexcept;
+
   protected:
-    inline void
+    using clock_type = std::chrono::steady_clock;
+
+    template < class QueuePolicy = fifo_wait_queue >
+    void
     add_waiter(detail::semaphore_wait_op *waiter);
 
+    /// @brief Expire waiter at when, arming the semaphore's single deadline
+    /// timer on exec if it is the earliest deadline.
+    /// @pre waiter has been added with add_waiter
+    /// @note If this throws, waiter has been taken out of the queue again.
+    template < class Executor >
+    void
+    add_deadline(detail::semaphore_wait_op *waiter,
+                 clock_type::time_point     when,
+                 Executor const            &exec);
+
     inline int
-    decrement();
+    decrement(int n = 1);
+
+    /// @brief Add n units to the inbox of releases from other threads.
+    /// @returns true if the inbox was empty, in which case the caller must
+    /// arrange for drain_inbox to be called on the owning executor.
+    inline bool
+    push_inbox(int n) noexcept;
+
+    /// @brief Release every unit in the inbox.
+    inline void
+    drain_inbox();
 
     ASIO_NODISCARD inline int
     count() const noexcept;
 
   private:
-    detail::bilist_node waiters_;
-    int                 count_;
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(detail::semaphore_wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    template < class Host, class Executor >
+    friend struct detail::semaphore_deadline_timer_impl;
+
+    /// @brief Complete every waiter whose deadline is not after now with
+    /// error::timed_out, in one batch.
+    inline void
+    expire_waiters(clock_type::time_point now);
+
+    /// @brief Take a waiter which is leaving the queue out of the deadline
+    /// list.
+    inline void
+    forget_deadline(detail::semaphore_wait_op *waiter);
+
+    using deadline_link =
+        detail::semaphore_deadline_link< detail::semaphore_wait_op >;
+    using deadline_timer =
+        detail::semaphore_deadline_timer< async_semaphore_base >;
+
+    detail::sized_bilist              waiters_;
+    int                               count_;
+    int                               demand_;
+    wait_op_pool_stats                pool_stats_;
+    detail::bilist_node               deadlines_;
+    std::shared_ptr< deadline_timer > deadline_timer_;
+    std::atomic< int >                inbox_;
 };
 
-template < class Executor = asio::any_io_executor >
+/// @tparam QueuePolicy decides the order in which pending async_acquire
+/// operations are served. One of fifo_wait_queue (the default),
+/// lifo_wait_queue or priority_wait_queue.
+/// @tparam StatsPolicy decides which contention statistics are kept. Either
+/// null_sync_stats (the default), which keeps none at no cost, or sync_stats.
+template < class Executor    = asio::any_io_executor,
+           class QueuePolicy = fifo_wait_queue,
+           class StatsPolicy = null_sync_stats >
 struct basic_async_semaphore : async_semaphore_base
 {
     /// @brief The type of the default executor.
     using executor_type = Executor;
 
+    /// @brief The policy which orders pending operations.
+    using queue_policy = QueuePolicy;
+
+    /// @brief The policy which keeps contention statistics.
+    using stats_policy = StatsPolicy;
+
     /// Rebinds the socket type to another executor.
     template < typename Executor1 >
     struct rebind_executor
     {
         /// The socket type when rebound to the specified executor.
-        typedef basic_async_semaphore< Executor1 > other;
+        typedef basic_async_semaphore< Executor1, QueuePolicy, StatsPolicy >
+            other;
     };
 
     /// @brief Construct an async_sempaphore
@@ -96,18 +212,39 @@ struct basic_async_semaphore : async_semaphore_base
     executor_type const &
     get_executor() const;
 
+    /// @brief Release n units of the semaphore from any thread.
+    /// @details Unlike release, this may be called from any thread, for
+    /// example by a thread pool worker reporting that a blocking task is
+    /// done. The units are added to an atomic inbox. Only the release which
+    /// finds the inbox empty posts work to the semaphore's executor, and that
+    /// work releases everything accumulated in the inbox by the time it runs
+    /// in a single call to release. A burst of completions therefore costs
+    /// one atomic add each and one post between them.
+    /// @note The semaphore must outlive every release_from_any_thread which
+    /// has not yet been drained.
+    /// @param n is the number of units to release.
+    /// @pre n >= 0
+    void
+    release_from_any_thread(int n = 1);
+
+    /// @brief A copy of the contention statistics kept so far.
+    /// @details All zero unless StatsPolicy keeps statistics.
+    sync_stats_snapshot
+    stats() const noexcept;
+
     /// @brief Initiate an asynchronous acquire of the semaphore
     /// @details Multiple asynchronous acquire operations may be in progress at
     /// the same time. However, the caller must ensure that this function is not
     /// invoked from two threads simultaneously. When the semaphore's internal
-    /// count is above zero, async acquire operations will complete in strict
-    /// FIFO order. If the semaphore object is destoyed while an async_acquire
-    /// is outstanding, the operation's completion handler will be invoked with
-    /// the error_code set to error::operation_aborted. If the async_acquire
-    /// operation is cancelled before completion, the completion handler will be
-    /// invoked with the error_code set to error::operation_aborted. Successful
-    /// acquisition of the semaphore is signalled to the caller when the
-    /// completion handler is invoked with no error.
+    /// count is above zero, async acquire operations will complete in the
+    /// order given by the queue policy, strict FIFO by default. If the
+    /// semaphore object is destoyed while an async_acquire is outstanding, the
+    /// operation's completion handler will be invoked with the error_code set
+    /// to error::operation_aborted. If the async_acquire operation is cancelled
+    /// before completion, the completion handler will be invoked with the
+    /// error_code set to error::operation_aborted. Successful acquisition of
+    /// the semaphore is signalled to the caller when the completion handler is
+    /// invoked with no error.
     /// @tparam CompletionHandler represents a completion token or handler which
     /// is invokable with the signature `void(error_code)`
     /// @param token is a completion token or handler matching the signature
@@ -116,14 +253,62 @@ struct basic_async_semaphore : async_semaphore_base
     /// handler's associated executor. If no executor is associated with the
     /// completion handler, the handler will be invoked as if by `post` to the
     /// async_semaphore's associated default executor.
+    /// @note If the token is adapted with asioex::immediate and the semaphore
+    /// can be acquired without waiting, the completion handler is invoked as
+    /// if by `dispatch` instead, which avoids a trip through the scheduler
+    /// when the caller is already running on the handler's executor.
+    /// @note For a semaphore shared between threads see
+    /// mt::basic_async_semaphore.
     template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
                    ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
     ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
     async_acquire(
         CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
 
+    /// @brief Initiate an asynchronous acquire of n units of the semaphore
+    /// @details As async_acquire(token), but the operation completes only
+    /// once n units are available, and takes all of them at once. Requests are
+    /// served in queue order regardless of size.
+    /// @param n is the number of units to acquire.
+    /// @pre n >= 0
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+    async_acquire(
+        int n,
+        CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Initiate an asynchronous acquire of the semaphore which gives
+    /// up at a deadline.
+    /// @details As async_acquire(token), except that if the semaphore has
+    /// not been acquired by the deadline the operation completes with
+    /// error::timed_out. Rather than a timer per operation, the semaphore
+    /// keeps its waiters in deadline order and arms a single timer for the
+    /// earliest one. Waiters which expire together are completed in a batch.
+    /// @param deadline is the latest time at which to acquire.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+    async_acquire_until(
+        std::chrono::steady_clock::time_point deadline,
+        CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Initiate an asynchronous acquire of n units of the semaphore
+    /// which gives up at a deadline.
+    /// @param n is the number of units to acquire.
+    /// @param deadline is the latest time at which to acquire.
+    /// @pre n >= 0
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+    async_acquire_until(
+        int                                   n,
+        std::chrono::steady_clock::time_point deadline,
+        CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
   private:
-    executor_type exec_;
+    executor_type                     exec_;
+    [[no_unique_address]] StatsPolicy stats_;
 };
 
 using async_semaphore = basic_async_semaphore<>;
@@ -5,81 +5,229 @@
 #ifndef ASIO_EXPERIMENTS_CONDITION_VARIABLE_HPP
 #define ASIO_EXPERIMENTS_CONDITION_VARIABLE_HPP
 
-#include <asioex/async_semaphore.hpp>
+#include <asioex/detail/predicate_handler.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/immediate.hpp>
+#include <asioex/mutex.hpp>
+#include <asioex/sync_stats.hpp>
 #include <asio/compose.hpp>
+#include <asio/error.hpp>
+#include <asio/post.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
 
 namespace asioex
 {
 
-template<typename Executor = asio::any_io_executor>
-struct basic_condition_variable
+/// @brief The executor-independent part of basic_condition_variable.
+/// @details Notifications are never stored: a notify with nobody waiting, or
+/// nobody whose predicate holds, has no effect.
+struct condition_variable_base
+{
+    condition_variable_base() = default;
+
+    condition_variable_base(condition_variable_base const &) = delete;
+
+    condition_variable_base &
+    operator=(condition_variable_base const &) = delete;
+
+    ~condition_variable_base()
+    {
+        detail::complete_all< condition_variable_base >(
+            waiters_, asio::error::operation_aborted);
+    }
+
+    /// Resume the least recent waiter whose predicate holds.
+    void
+    notify_one()
+    {
+        if (waiters_.empty())
+            return;
+
+        for (auto n = waiters_.front(); n != waiters_.end(); n = n->next_)
+        {
+            auto op = static_cast< wait_op * >(n);
+            if (op->ready())
+            {
+                waiters_.erase(op);
+                op->complete(error_code());
+                return;
+            }
+        }
+    }
+
+    /// Resume every waiter whose predicate holds, in one batch.
+    void
+    notify_all()
+    {
+        if (waiters_.empty())
+            return;
+
+        detail::sized_bilist ready;
+        try
+        {
+            for (auto n = waiters_.front(); n != waiters_.end();)
+            {
+                auto op = static_cast< wait_op * >(n);
+                n       = n->next_;
+                if (op->ready())
+                {
+                    waiters_.erase(op);
+                    ready.push_back(op);
+                }
+            }
+        }
+        catch (...)
+        {
+            // a throwing predicate leaves its own waiter queued
+            detail::complete_all< condition_variable_base >(ready, error_code());
+            throw;
+        }
+        detail::complete_all< condition_variable_base >(ready, error_code());
+    }
+
+    /// The number of pending waits.
+    std::size_t
+    waiters() const noexcept
+    {
+        return waiters_.size();
+    }
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< condition_variable_base >;
+
+    void
+    add_waiter(wait_op *waiter)
+    {
+        waiters_.push_back(waiter);
+    }
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    void
+    cancel_waiter(wait_op *waiter)
+    {
+        waiters_.erase(waiter);
+        waiter->complete(asio::error::operation_aborted);
+    }
+
+    void
+    record_pool_allocation(bool) noexcept
+    {
+    }
+
+    detail::sized_bilist waiters_;
+};
+
+/// @tparam StatsPolicy decides which contention statistics are kept. Either
+/// null_sync_stats (the default), which keeps none at no cost, or sync_stats.
+/// A wait whose predicate already holds counts as a fast path hit.
+template<typename Executor = asio::any_io_executor,
+         typename StatsPolicy = null_sync_stats>
+struct basic_condition_variable : condition_variable_base
 {
     /// @brief The type of the default executor.
     using executor_type = Executor;
 
+    /// @brief The policy which keeps contention statistics.
+    using stats_policy = StatsPolicy;
+
     /// @brief Construct a condition_variable
     /// @param exec is the default executor associated with the condition_variable
     explicit basic_condition_variable(executor_type exec)
-    : semaphore_(std::move(exec), 0)
+    : exec_(std::move(exec))
     {
     }
 
     /// @brief Initiate an asynchronous wait on the condition_variable
+    /// @details The wait completes on the next notify_one or notify_all issued
+    /// after initiation.
     template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
                    ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
     ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
     async_wait(CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
     {
-        return semaphore_.async_acquire(std::forward< CompletionToken >(token));
+        return asio::async_initiate< CompletionToken, void(error_code) >(
+            [this]< class Handler >(Handler &&handler)
+            {
+                stats_.on_acquire();
+                park(std::forward< Handler >(handler));
+            },
+            token);
     }
 
     /// @brief Initiate an asynchronous wait on the condition_variable with a predicate.
-    template < typename Predicate,
+    /// @details The predicate is checked at initiation and then by each
+    /// notification. Only a notification which finds it true resumes the
+    /// waiter, so the handler never sees a false predicate.
+    template < std::predicate Predicate,
                 ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
                    ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
     ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
     async_wait(Predicate && predicate,
                CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
     {
-        return asio::async_compose<CompletionToken, void(error_code)>(
-            [&,
-             predicate = std::move(predicate),
-             did_suspend = false](auto& self, error_code ec = {}) mutable
+        return asio::async_initiate< CompletionToken, void(error_code) >(
+            [this]< class Handler, class Pred >(Handler &&handler, Pred &&pred)
             {
-                if (ec)
-                    std::move(self).complete(ec);
-                else if (predicate())
+                stats_.on_acquire();
+                if (pred())
                 {
-                    if (did_suspend)
-                        std::move(self).complete(ec);
-                    else
-                        asio::post(
-                            get_associated_executor(self, get_executor()),
-                            [s = std::move(self)]() mutable
-                            {
-                                std::move(s).complete(error_code{});
-                            });
+                    stats_.on_fast_path();
+                    auto e = get_associated_executor(handler, get_executor());
+                    detail::complete_now(
+                        e, std::forward< Handler >(handler), error_code());
+                    return;
                 }
-                else
-                {
-                    did_suspend = true;
-                    semaphore_.async_acquire(std::move(self));
-                }
-            }, token, *this);
+
+                park(detail::predicate_handler< std::decay_t< Pred >,
+                                                std::decay_t< Handler > >(
+                    std::forward< Pred >(pred), std::forward< Handler >(handler)));
+            },
+            token, std::forward< Predicate >(predicate));
     }
 
-    /// Notify one waitor.
-    void
-    notify_one()
+    /// @brief Atomically unlock mtx and wait, then reacquire mtx.
+    /// @details The caller must own mtx. The handler runs owning mtx again,
+    /// unless the error is from reacquiring mtx itself.
+    template < typename MutexExecutor,
+                typename MutexStats,
+                ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_wait(basic_mutex< MutexExecutor, MutexStats > & mtx,
+               CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
     {
-        semaphore_.release();
+        return async_wait_locked(mtx, nullptr, std::forward< CompletionToken >(token));
     }
 
-    /// Notify everyone waiting for the condition_variable.
-    void
-    notify_all()
+    /// @brief Atomically unlock mtx and wait until predicate holds, then
+    /// reacquire mtx.
+    /// @details The caller must own mtx. The predicate is checked on
+    /// notification to decide whether to wake, and again once mtx has been
+    /// reacquired; if it no longer holds the wait resumes. The predicate must
+    /// be copy constructible.
+    template < typename MutexExecutor,
+                typename MutexStats,
+                std::predicate Predicate,
+                ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_wait(basic_mutex< MutexExecutor, MutexStats > & mtx,
+               Predicate && predicate,
+               CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
     {
-        semaphore_.release_all();
+        return async_wait_locked(mtx,
+                                 std::forward< Predicate >(predicate),
+                                 std::forward< CompletionToken >(token));
     }
 
     /// Rebinds the condition_variable type to another executor.
@@ -87,18 +235,125 @@ struct basic_condition_variable
     struct rebind_executor
     {
         /// The condition_variable type when rebound to the specified executor.
-        typedef basic_condition_variable<Executor1> other;
+        typedef basic_condition_variable<Executor1, StatsPolicy> other;
     };
 
-    template<typename Executor_>
-    friend class basic_condition_variable;
+    template<typename Executor_, typename StatsPolicy_>
+    friend struct basic_condition_variable;
 
     /// @brief return the default executor.
     executor_type const &
-    get_executor() const {return semaphore_.get_executor();}
+    get_executor() const {return exec_;}
+
+    /// @brief A copy of the contention statistics kept so far.
+    /// @details All zero unless StatsPolicy keeps statistics.
+    sync_stats_snapshot
+    stats() const noexcept
+    {
+        return stats_.snapshot();
+    }
 
   private:
-    basic_async_semaphore<Executor> semaphore_;
+    template < class Handler >
+    void
+    park(Handler &&handler)
+    {
+        auto e = get_associated_executor(handler, get_executor());
+        auto &&parked =
+            stats_.on_park(waiters() + 1, std::forward< Handler >(handler));
+        using model_type =
+            detail::semaphore_wait_op_model< decltype(e),
+                                             std::decay_t< decltype(parked) >,
+                                             condition_variable_base >;
+        add_waiter(model_type::construct(
+            this, 0, std::move(e), std::forward< decltype(parked) >(parked)));
+    }
+
+    // Predicate is std::nullptr_t for an unconditional wait
+    template < typename MutexExecutor,
+               typename MutexStats,
+               typename Predicate,
+               typename CompletionToken >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_wait_locked(basic_mutex< MutexExecutor, MutexStats > & mtx,
+                      Predicate && predicate,
+                      CompletionToken && token)
+    {
+        constexpr bool has_predicate =
+            !std::is_null_pointer< std::decay_t< Predicate > >::value;
+
+        enum state_t
+        {
+            starting,
+            waiting,
+            locking
+        };
+
+        return asio::async_compose<CompletionToken, void(error_code)>(
+            [this,
+             &mtx,
+             predicate = std::forward< Predicate >(predicate),
+             state = starting,
+             wait_ec = error_code()](auto& self, error_code ec = {}) mutable
+            {
+                switch (state)
+                {
+                case starting:
+                    stats_.on_acquire();
+                    if constexpr (has_predicate)
+                    {
+                        if (predicate())
+                        {
+                            stats_.on_fast_path();
+                            asio::post(
+                                get_associated_executor(self, get_executor()),
+                                [s = std::move(self)]() mutable
+                                {
+                                    std::move(s).complete(error_code{});
+                                });
+                            return;
+                        }
+                    }
+                    break;
+
+                case waiting:
+                    // reacquire the mutex whatever the outcome of the wait
+                    wait_ec = ec;
+                    state = locking;
+                    mtx.async_lock(std::move(self));
+                    return;
+
+                case locking:
+                    if (ec || wait_ec)
+                    {
+                        std::move(self).complete(ec ? ec : wait_ec);
+                        return;
+                    }
+                    if constexpr (has_predicate)
+                    {
+                        // the state may have changed before we got the mutex
+                        if (!predicate())
+                            break;
+                    }
+                    std::move(self).complete(error_code{});
+                    return;
+                }
+
+                // queue before unlocking so that no notification issued by
+                // the next owner of the mutex can be missed
+                state = waiting;
+                if constexpr (has_predicate)
+                    park(detail::predicate_handler< std::decay_t< Predicate >,
+                                                    std::decay_t< decltype(self) > >(
+                        predicate, std::move(self)));
+                else
+                    park(std::move(self));
+                mtx.unlock();
+            }, token, *this);
+    }
+
+    executor_type                     exec_;
+    [[no_unique_address]] StatsPolicy stats_;
 };
 
 using condition_variable = basic_condition_variable<>;
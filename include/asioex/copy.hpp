@@ -5,41 +5,149 @@
 #ifndef ASIO_EXPERIMENTS_COPY_HPP
 #define ASIO_EXPERIMENTS_COPY_HPP
 
+#include <asio/associated_cancellation_slot.hpp>
+#include <asio/associated_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/basic_waitable_timer.hpp>
+#include <asio/buffer.hpp>
+#include <asio/cancellation_signal.hpp>
 #include <asio/compose.hpp>
+#include <asio/error.hpp>
+#include <asio/executor_work_guard.hpp>
 #include <asio/experimental/prepend.hpp>
+#include <asio/post.hpp>
+#include <asio/steady_timer.hpp>
+#include <asioex/detail/expanding_circular_buffer.hpp>
+#include <asioex/weight.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace asioex
 {
 
+/// Lets another thread watch an `async_copy` while it runs.
+struct copy_progress
+{
+    std::atomic<std::size_t> items{0u};
+    /// Counts the bytes of the values that are buffer sequences or
+    /// contiguous ranges of trivially copyable elements. Other values count as
+    /// no bytes.
+    std::atomic<std::size_t> bytes{0u};
+};
+
+struct copy_options
+{
+    /// If set, is updated after every value written.
+    copy_progress * progress = nullptr;
+    /// If not 0, the copy is held to this many bytes per second on average.
+    std::size_t rate_limit = 0u;
+    /// How many bytes may be copied at once before the rate limit applies.
+    /// 0 means a tenth of a second's worth.
+    std::size_t burst = 0u;
+};
+
+namespace detail
+{
+
+template<typename T>
+std::size_t copied_bytes(T const & value)
+{
+    if constexpr (asio::is_const_buffer_sequence<T>::value)
+        return asio::buffer_size(value);
+    else if constexpr (std::ranges::contiguous_range<T const> && std::ranges::sized_range<T const>)
+    {
+        // elements such as strings own memory that sizeof does not see
+        if constexpr (std::is_trivially_copyable_v<std::ranges::range_value_t<T const>>)
+            return std::ranges::size(value) * sizeof(std::ranges::range_value_t<T const>);
+        else
+            return 0u;
+    }
+    else
+        return 0u;
+}
+
+// A token bucket which may go into debt, so that a value larger than the
+// burst is still let through, and the wait is taken before the next one.
+struct copy_rate_limiter
+{
+    using clock_type = std::chrono::steady_clock;
+
+    double rate = 0.;
+    double burst = 0.;
+    double tokens = 0.;
+    clock_type::time_point last = clock_type::now();
+
+    explicit copy_rate_limiter(copy_options const & options)
+        : rate(double(options.rate_limit)),
+          burst(options.burst ? double(options.burst) : rate / 10.),
+          tokens(burst)
+    {
+    }
+
+    // takes the bytes and returns how long to wait until the bucket is out of debt
+    clock_type::duration take(std::size_t bytes)
+    {
+        auto now = clock_type::now();
+        tokens = (std::min)(burst, tokens + rate * std::chrono::duration<double>(now - last).count());
+        last = now;
+        tokens -= double(bytes);
+        if (tokens >= 0.)
+            return clock_type::duration::zero();
+        return std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(-tokens / rate));
+    }
+};
+
+}
+
 template<typename SourceOp, typename SinkOp>
 struct async_copy_op
 {
     SourceOp source;
     SinkOp sink;
+    copy_options options = {};
 
     std::size_t completed = 0u;
+    std::size_t pending_bytes = 0u;
+    std::optional<detail::copy_rate_limiter> limiter;
+    // on the heap, so that it stays put while the op moves into its own wait
+    std::unique_ptr<asio::steady_timer> timer;
     struct source_tag{};
     struct sink_tag{};
+    struct throttle_tag{};
 
     template<typename Self>
     void operator()(Self && self)
     {
-        completed --;
+        if (options.rate_limit)
+            limiter.emplace(options);
         source(asio::experimental::prepend(std::move(self), source_tag{}));
     }
 
     template<typename Self, typename ... Args>
     void operator()(Self && self, source_tag, asio::error_code ec, Args && ... args)
     {
-        completed++;
         if (!ec && self.get_cancellation_state().cancelled() == asio::cancellation_type::terminal)
             ec = asio::error::operation_aborted;
 
-        if (!ec)
-            sink(std::forward<Args>(args)...,
-                asio::experimental::prepend(std::move(self), sink_tag{}));
-        else
-            self.complete(ec, completed);
+        if (ec)
+            return self.complete(ec, completed);
+        if (options.progress || limiter)
+            pending_bytes = (std::size_t(0u) + ... + detail::copied_bytes(args));
+        sink(std::forward<Args>(args)...,
+             asio::experimental::prepend(std::move(self), sink_tag{}));
     }
 
     template<typename Self, typename ... Args>
@@ -47,13 +155,44 @@ struct async_copy_op
     {
         if (!ec && self.get_cancellation_state().cancelled() != asio::cancellation_type::none)
             ec = asio::error::operation_aborted;
-        if (!ec)
-            source(asio::experimental::prepend(std::move(self), source_tag{}));
-        else
-            self.complete(ec, completed);
+        if (ec)
+            return self.complete(ec, completed);
+
+        completed++;
+        if (options.progress)
+        {
+            options.progress->items.fetch_add(1u, std::memory_order_relaxed);
+            options.progress->bytes.fetch_add(pending_bytes, std::memory_order_relaxed);
+        }
+        if (limiter)
+        {
+            auto wait = limiter->take(pending_bytes);
+            if (wait > wait.zero())
+            {
+                if (!timer)
+                    timer = std::make_unique<asio::steady_timer>(self.get_executor());
+                timer->expires_after(wait);
+                auto & t = *timer;
+                return t.async_wait(asio::experimental::prepend(std::move(self), throttle_tag{}));
+            }
+        }
+        source(asio::experimental::prepend(std::move(self), source_tag{}));
+    }
+
+    template<typename Self>
+    void operator()(Self && self, throttle_tag, asio::error_code ec)
+    {
+        if (ec)
+            return self.complete(ec, completed);
+        source(asio::experimental::prepend(std::move(self), source_tag{}));
     }
 };
 
+/// Copy from `source` to `sink` until either fails.
+///
+/// `source` is invoked with a completion handler taking an `error_code` and
+/// any values, and `sink` with those values and a completion handler taking
+/// an `error_code`. Completes with the error and the number of values written.
 template<typename SourceOp, typename SinkOp, typename CompletionToken>
 auto async_copy(SourceOp && source, SinkOp && sink, CompletionToken && token)
 {
@@ -65,6 +204,900 @@ auto async_copy(SourceOp && source, SinkOp && sink, CompletionToken && token)
 
 }
 
+/// Copy from `source` to `sink` as above, reporting progress and keeping to a
+/// rate limit as set in `options`.
+///
+/// The rate limit waits on a timer that runs on the completion handler's
+/// associated executor, which defaults to `exec`.
+template<typename Executor, typename SourceOp, typename SinkOp, typename CompletionToken>
+auto async_copy(Executor const & exec, SourceOp && source, SinkOp && sink, copy_options options,
+                CompletionToken && token)
+{
+    return asio::async_compose<CompletionToken, void(std::error_code, std::size_t)>(
+                    async_copy_op<SourceOp, SinkOp>{
+                        std::forward<SourceOp>(source),
+                        std::forward<SinkOp>(sink),
+                        options
+                    }, token, exec);
+}
+
+namespace detail
+{
+
+// A source result waiting for the sink. The type of the values is only known
+// once the source has completed, so they are held behind a virtual call.
+template<typename State>
+struct pipelined_value_base
+{
+    virtual ~pipelined_value_base() = default;
+    virtual void write(State & state) = 0;
+};
+
+template<typename State, typename ... Args>
+struct pipelined_value final : pipelined_value_base<State>
+{
+    template<typename ... Ts>
+    explicit pipelined_value(Ts && ... ts) : values(std::forward<Ts>(ts)...) {}
+
+    std::tuple<Args...> values;
+
+    void write(State & state) override
+    {
+        std::apply(
+            [&](auto & ... vs)
+            {
+                state.sink(std::move(vs)...,
+                           typename State::sink_handler{state.shared_from_this()});
+            }, values);
+    }
+};
+
+template<typename SourceOp, typename SinkOp, typename Executor, typename Handler>
+struct pipelined_copy_state
+    : std::enable_shared_from_this<pipelined_copy_state<SourceOp, SinkOp, Executor, Handler>>
+{
+    using executor_type = asio::associated_executor_t<Handler, Executor>;
+
+    struct handler_base
+    {
+        std::shared_ptr<pipelined_copy_state> state;
+
+        using executor_type = typename pipelined_copy_state::executor_type;
+        executor_type get_executor() const noexcept { return state->work.get_executor(); }
+
+        using cancellation_slot_type = asio::cancellation_slot;
+    };
+
+    struct source_handler : handler_base
+    {
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->source_signal.slot();
+        }
+
+        template<typename ... Args>
+        void operator()(asio::error_code ec, Args && ... args)
+        {
+            this->state->on_source(ec, std::forward<Args>(args)...);
+        }
+    };
+
+    struct sink_handler : handler_base
+    {
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->sink_signal.slot();
+        }
+
+        template<typename ... Args>
+        void operator()(asio::error_code ec, Args && ...)
+        {
+            this->state->on_sink(ec);
+        }
+    };
+
+    // forwards a cancellation of the whole copy to both children. As with
+    // the overload without depth, a completed write stops the copy on any
+    // kind of cancellation, and a completed read only on a terminal one.
+    struct canceller
+    {
+        pipelined_copy_state * state;
+
+        void operator()(asio::cancellation_type type)
+        {
+            state->cancelled = state->cancelled | type;
+            state->source_signal.emit(type);
+            state->sink_signal.emit(type);
+        }
+    };
+
+    template<typename Source, typename Sink, typename H>
+    pipelined_copy_state(Executor const & exec, Source && source, Sink && sink, std::size_t depth, H && h)
+        : source(std::forward<Source>(source)), sink(std::forward<Sink>(sink)),
+          depth(depth), slot(asio::get_associated_cancellation_slot(h)),
+          work(asio::get_associated_executor(h, exec)), handler(std::forward<H>(h))
+    {
+    }
+
+    SourceOp source;
+    SinkOp sink;
+    std::size_t depth;
+    asio::cancellation_slot slot;
+    asio::executor_work_guard<executor_type> work;
+    Handler handler;
+
+    asio::cancellation_signal source_signal, sink_signal;
+    expanding_circular_buffer<std::unique_ptr<pipelined_value_base<pipelined_copy_state>>> buffer;
+    bool reading = false, writing = false, source_done = false;
+    asio::cancellation_type cancelled = asio::cancellation_type::none;
+    asio::error_code error;
+    std::size_t completed = 0u;
+
+    void start()
+    {
+        if (slot.is_connected())
+            slot.template emplace<canceller>(canceller{this});
+        read();
+    }
+
+    // read ahead while the waiting results and this read fit in depth, and
+    // always when the sink has nothing to do, so that a depth of 0 alternates
+    void read()
+    {
+        if (reading || source_done)
+            return;
+        if (buffer.size() >= depth && (writing || !buffer.empty()))
+            return;
+        reading = true;
+        source(source_handler{{this->shared_from_this()}});
+    }
+
+    void write()
+    {
+        if (writing || buffer.empty())
+            return;
+        writing = true;
+        buffer.pop()->write(*this);
+    }
+
+    template<typename ... Args>
+    void on_source(asio::error_code ec, Args && ... args)
+    {
+        reading = false;
+        if (!ec && (cancelled & asio::cancellation_type::terminal) != asio::cancellation_type::none)
+            ec = asio::error::operation_aborted;
+
+        if (source_done)
+            ; // the sink failed while this read was in flight
+        else if (ec)
+        {
+            // the source has ended: what was read before still gets written,
+            // unless the copy was cancelled
+            source_done = true;
+            error = ec;
+            if (ec == asio::error::operation_aborted)
+                buffer.clear();
+        }
+        else
+            buffer.push(std::make_unique<pipelined_value<pipelined_copy_state, std::decay_t<Args>...>>(
+                    std::forward<Args>(args)...));
+        step();
+    }
+
+    void on_sink(asio::error_code ec)
+    {
+        writing = false;
+        if (!ec)
+            completed++;
+        if (!ec && cancelled != asio::cancellation_type::none)
+            ec = asio::error::operation_aborted;
+
+        if (ec)
+        {
+            // a failed write matters more than the end of the source, and a
+            // read in flight would otherwise hold the copy open until the
+            // source completes
+            error = ec;
+            source_done = true;
+            buffer.clear();
+            if (reading)
+                source_signal.emit(asio::cancellation_type::terminal);
+        }
+        step();
+    }
+
+    void step()
+    {
+        write();
+        read();
+        if (!reading && !writing && buffer.empty() && source_done)
+            finish();
+    }
+
+    void finish()
+    {
+        if (slot.is_connected())
+            slot.clear();
+        auto w = std::move(work);
+        auto h = std::move(handler);
+        auto ec = error;
+        auto n = completed;
+        std::move(h)(ec, n);
+    }
+};
+
+}
+
+/// Copy from `source` to `sink` while reading up to `depth` source results
+/// ahead of the sink, so that reads overlap writes.
+///
+/// A read in progress counts towards `depth`, and the result the sink is
+/// writing does not, so at most `depth + 1` results are in flight. With a
+/// depth of 0 the source is only invoked while the sink is idle, as with the
+/// overload without depth.
+///
+/// Results are written in the order they were read. The copy ends with the
+/// first error. If that is an error from the source, the results already read
+/// are written first.
+///
+/// The source and sink are given handlers whose associated executor is the
+/// completion handler's, which defaults to `exec`. The copy counts as work on
+/// it.
+///
+/// Completes with the error and the number of results written.
+template<typename Executor, typename SourceOp, typename SinkOp, typename CompletionToken>
+auto async_copy(Executor const & exec, SourceOp && source, SinkOp && sink, std::size_t depth,
+                CompletionToken && token)
+{
+    return asio::async_initiate<CompletionToken, void(std::error_code, std::size_t)>(
+        [exec, depth](auto handler, auto && source, auto && sink)
+        {
+            using state_type = detail::pipelined_copy_state<
+                std::decay_t<SourceOp>, std::decay_t<SinkOp>, Executor, decltype(handler)>;
+            std::make_shared<state_type>(
+                exec, std::forward<decltype(source)>(source),
+                std::forward<decltype(sink)>(sink),
+                depth, std::move(handler))->start();
+        }, token, std::forward<SourceOp>(source), std::forward<SinkOp>(sink));
+}
+
+
+/// Counts the batches handed to the sink by `async_copy_batched`.
+struct copy_batch_stats
+{
+    std::size_t batches = 0u;
+    std::size_t items = 0u;
+    std::size_t largest = 0u;
+    /// `sizes[k]` counts the batches of between 2^k and 2^(k+1) - 1 items.
+    std::array<std::size_t, 16> sizes{};
+
+    void record(std::size_t n)
+    {
+        batches++;
+        items += n;
+        largest = (std::max)(largest, n);
+        sizes[(std::min)(std::size_t(std::bit_width(n) - 1), sizes.size() - 1)]++;
+    }
+};
+
+/// Bounds the batches of `async_copy_batched`. A batch is written once it
+/// holds `max_items`, or weighs `max_weight` according to `weight`, or once
+/// its first item has waited `max_delay` for the sink to take it.
+template<typename Weight = unit_weight>
+struct copy_batch_limits
+{
+    std::size_t max_items = 64u;
+    std::size_t max_weight = (std::numeric_limits<std::size_t>::max)();
+    std::chrono::steady_clock::duration max_delay{};
+    Weight weight{};
+    /// If set, every batch is recorded here.
+    copy_batch_stats * stats = nullptr;
+};
+
+namespace detail
+{
+
+template<typename T, typename SourceOp, typename SinkOp, typename Weight, typename Executor, typename Handler>
+struct batched_copy_state
+    : std::enable_shared_from_this<batched_copy_state<T, SourceOp, SinkOp, Weight, Executor, Handler>>
+{
+    using executor_type = asio::associated_executor_t<Handler, Executor>;
+    using clock_type = std::chrono::steady_clock;
+    using timer_type = asio::basic_waitable_timer<clock_type, asio::wait_traits<clock_type>, executor_type>;
+
+    struct handler_base
+    {
+        std::shared_ptr<batched_copy_state> state;
+
+        using executor_type = typename batched_copy_state::executor_type;
+        executor_type get_executor() const noexcept { return state->work.get_executor(); }
+
+        using cancellation_slot_type = asio::cancellation_slot;
+    };
+
+    struct source_handler : handler_base
+    {
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->source_signal.slot();
+        }
+
+        template<typename U>
+        void operator()(asio::error_code ec, U && value)
+        {
+            this->state->on_source(ec, std::forward<U>(value));
+        }
+    };
+
+    struct sink_handler : handler_base
+    {
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->sink_signal.slot();
+        }
+
+        template<typename ... Args>
+        void operator()(asio::error_code ec, Args && ...)
+        {
+            this->state->on_sink(ec);
+        }
+    };
+
+    struct canceller
+    {
+        batched_copy_state * state;
+
+        void operator()(asio::cancellation_type type)
+        {
+            if ((type & asio::cancellation_type::terminal) == asio::cancellation_type::none)
+                return;
+            state->cancelled = true;
+            state->source_signal.emit(asio::cancellation_type::terminal);
+            state->sink_signal.emit(asio::cancellation_type::terminal);
+            if (state->timer)
+                state->timer->cancel();
+        }
+    };
+
+    template<typename Source, typename Sink, typename H>
+    batched_copy_state(Executor const & exec, Source && source, Sink && sink,
+                       copy_batch_limits<Weight> limits, H && h)
+        : source(std::forward<Source>(source)), sink(std::forward<Sink>(sink)),
+          limits(std::move(limits)), slot(asio::get_associated_cancellation_slot(h)),
+          work(asio::get_associated_executor(h, exec)), handler(std::forward<H>(h))
+    {
+        if (this->limits.max_delay > clock_type::duration::zero())
+            timer.emplace(work.get_executor());
+    }
+
+    SourceOp source;
+    SinkOp sink;
+    copy_batch_limits<Weight> limits;
+    asio::cancellation_slot slot;
+    asio::executor_work_guard<executor_type> work;
+    Handler handler;
+
+    asio::cancellation_signal source_signal, sink_signal;
+    std::optional<timer_type> timer;
+
+    // items are gathered in pending while the sink writes batch, then the
+    // two swap, so that their capacity is reused
+    std::vector<T> pending, batch;
+    std::size_t pending_weight = 0u;
+    clock_type::time_point first_pending;
+
+    bool reading = false, writing = false, waiting = false, source_done = false, cancelled = false;
+    asio::error_code error;
+    std::size_t completed = 0u;
+
+    void start()
+    {
+        if (slot.is_connected())
+            slot.template emplace<canceller>(canceller{this});
+        step();
+    }
+
+    bool full() const
+    {
+        return pending.size() >= limits.max_items || pending_weight >= limits.max_weight;
+    }
+
+    // whether the pending items should be written as soon as the sink is idle
+    bool due() const
+    {
+        return full() || source_done || !timer || clock_type::now() >= first_pending + limits.max_delay;
+    }
+
+    void read()
+    {
+        if (reading || source_done || full())
+            return;
+        reading = true;
+        source(source_handler{{this->shared_from_this()}});
+    }
+
+    void write()
+    {
+        if (writing || pending.empty())
+            return;
+
+        if (!due())
+        {
+            if (!waiting)
+            {
+                waiting = true;
+                timer->expires_at(first_pending + limits.max_delay);
+                timer->async_wait(
+                    [self = this->shared_from_this()](asio::error_code)
+                    {
+                        self->waiting = false;
+                        self->step();
+                    });
+            }
+            return;
+        }
+        if (waiting)
+            timer->cancel();
+
+        std::swap(pending, batch);
+        pending_weight = 0u;
+        writing = true;
+        if (limits.stats)
+            limits.stats->record(batch.size());
+        sink(std::span<T>(batch), sink_handler{{this->shared_from_this()}});
+    }
+
+    template<typename U>
+    void on_source(asio::error_code ec, U && value)
+    {
+        reading = false;
+        if (!ec && cancelled)
+            ec = asio::error::operation_aborted;
+
+        if (source_done)
+            ; // the sink failed while this read was in flight
+        else if (ec)
+        {
+            // the source has ended: what was read before still gets written,
+            // unless the copy was cancelled
+            source_done = true;
+            error = ec;
+            if (ec == asio::error::operation_aborted)
+                discard();
+        }
+        else
+        {
+            if (pending.empty())
+                first_pending = clock_type::now();
+            pending_weight += limits.weight(value);
+            pending.push_back(std::forward<U>(value));
+        }
+        step();
+    }
+
+    void on_sink(asio::error_code ec)
+    {
+        writing = false;
+        if (!ec)
+            completed += batch.size();
+        batch.clear();
+        if (!ec && cancelled)
+            ec = asio::error::operation_aborted;
+
+        if (ec)
+        {
+            // a failed write matters more than the end of the source, and a
+            // read in flight would otherwise hold the copy open until the
+            // source completes
+            error = ec;
+            source_done = true;
+            discard();
+            if (reading)
+                source_signal.emit(asio::cancellation_type::terminal);
+        }
+        step();
+    }
+
+    void discard()
+    {
+        pending.clear();
+        pending_weight = 0u;
+    }
+
+    void step()
+    {
+        read();
+        write();
+        if (!reading && !writing && !waiting && pending.empty() && source_done)
+            finish();
+    }
+
+    void finish()
+    {
+        if (slot.is_connected())
+            slot.clear();
+        auto w = std::move(work);
+        auto h = std::move(handler);
+        auto ec = error;
+        auto n = completed;
+        std::move(h)(ec, n);
+    }
+};
+
+}
+
+/// Copy the values of type `T` that `source` completes with to `sink` in
+/// batches.
+///
+/// The source is invoked as with `async_copy` and must complete with
+/// `(error_code, T)`. The sink is invoked with a `std::span<T>` of the batch
+/// and a completion handler, and may move from the span's elements.
+///
+/// The source is read while the sink is writing, and the values gathered are
+/// written as one batch once the sink is idle again. So a slow source gets
+/// one value per sink call and a slow sink gets up to `limits.max_items`. A
+/// non-zero `limits.max_delay` holds back a partial batch for up to that long
+/// in the hope of filling it.
+///
+/// The copy ends with the first error. If that is an error from the source,
+/// the values already read are written first.
+///
+/// The `max_delay` timer runs on the completion handler's associated
+/// executor, which defaults to `exec`, and the source and sink are given
+/// handlers associated with it too. The copy counts as work on it.
+///
+/// Completes with the error and the number of values written.
+template<typename T, typename Executor, typename SourceOp, typename SinkOp, typename Weight,
+         typename CompletionToken>
+auto async_copy_batched(Executor const & exec, SourceOp && source, SinkOp && sink,
+                        copy_batch_limits<Weight> limits, CompletionToken && token)
+{
+    return asio::async_initiate<CompletionToken, void(std::error_code, std::size_t)>(
+        [exec](auto handler, auto && source, auto && sink, copy_batch_limits<Weight> limits)
+        {
+            using state_type = detail::batched_copy_state<
+                T, std::decay_t<SourceOp>, std::decay_t<SinkOp>, Weight, Executor, decltype(handler)>;
+            std::make_shared<state_type>(
+                exec, std::forward<decltype(source)>(source),
+                std::forward<decltype(sink)>(sink),
+                std::move(limits), std::move(handler))->start();
+        }, token, std::forward<SourceOp>(source), std::forward<SinkOp>(sink), std::move(limits));
+}
+
+
+/// What became of each sink of an `async_broadcast_copy`.
+struct broadcast_copy_stats
+{
+    /// The number of values read from the source.
+    std::size_t items = 0u;
+    /// The number of values each sink has written.
+    std::vector<std::size_t> written;
+    /// Why each sink was dropped, if it was. `error::no_buffer_space` means
+    /// that it fell too far behind.
+    std::vector<asio::error_code> errors;
+};
+
+/// Governs how far the sinks of an `async_broadcast_copy` may drift apart.
+struct broadcast_copy_options
+{
+    /// How many sinks must have written a value before the next one is read.
+    /// If more sinks than this are left, the others may fall behind.
+    std::size_t quorum = (std::numeric_limits<std::size_t>::max)();
+    /// A sink that is more than this many values behind the source is
+    /// dropped, and its pending write is cancelled.
+    std::size_t max_lag = (std::numeric_limits<std::size_t>::max)();
+    /// If set, receives the outcome for each sink.
+    broadcast_copy_stats * stats = nullptr;
+};
+
+namespace detail
+{
+
+template<typename T, typename SourceOp, typename SinkOp, typename Executor, typename Handler>
+struct broadcast_copy_state
+    : std::enable_shared_from_this<broadcast_copy_state<T, SourceOp, SinkOp, Executor, Handler>>
+{
+    using executor_type = asio::associated_executor_t<Handler, Executor>;
+
+    struct handler_base
+    {
+        std::shared_ptr<broadcast_copy_state> state;
+
+        using executor_type = typename broadcast_copy_state::executor_type;
+        executor_type get_executor() const noexcept { return state->work.get_executor(); }
+
+        using cancellation_slot_type = asio::cancellation_slot;
+    };
+
+    struct source_handler : handler_base
+    {
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->source_signal.slot();
+        }
+
+        template<typename U>
+        void operator()(asio::error_code ec, U && value)
+        {
+            this->state->on_source(ec, std::forward<U>(value));
+        }
+    };
+
+    // keeps the value alive until the sink is done with it, even if the sink
+    // has been dropped in the meantime
+    struct sink_handler : handler_base
+    {
+        std::size_t index;
+        std::shared_ptr<T const> value;
+
+        asio::cancellation_slot get_cancellation_slot() const noexcept
+        {
+            return this->state->sink_states[index].signal.slot();
+        }
+
+        template<typename ... Args>
+        void operator()(asio::error_code ec, Args && ...)
+        {
+            value.reset();
+            this->state->on_sink(index, ec);
+        }
+    };
+
+    struct canceller
+    {
+        broadcast_copy_state * state;
+
+        void operator()(asio::cancellation_type type)
+        {
+            if ((type & asio::cancellation_type::terminal) == asio::cancellation_type::none)
+                return;
+            state->cancelled = true;
+            state->source_signal.emit(asio::cancellation_type::terminal);
+            for (std::size_t i = 0u; i < state->sinks.size(); i++)
+                state->sink_states[i].signal.emit(asio::cancellation_type::terminal);
+        }
+    };
+
+    struct sink_state
+    {
+        asio::cancellation_signal signal;
+        // the index of the next value to write
+        std::size_t next = 0u;
+        bool busy = false;
+        bool active = true;
+        asio::error_code error;
+    };
+
+    template<typename Source, typename H>
+    broadcast_copy_state(Executor const & exec, Source && source, std::vector<SinkOp> sinks,
+                         broadcast_copy_options options, H && h)
+        : source(std::forward<Source>(source)), sinks(std::move(sinks)),
+          sink_states(new sink_state[this->sinks.size()]), active(this->sinks.size()),
+          options(options), slot(asio::get_associated_cancellation_slot(h)),
+          work(asio::get_associated_executor(h, exec)), handler(std::forward<H>(h))
+    {
+    }
+
+    SourceOp source;
+    std::vector<SinkOp> sinks;
+    std::unique_ptr<sink_state[]> sink_states;
+    std::size_t active;
+    broadcast_copy_options options;
+    asio::cancellation_slot slot;
+    asio::executor_work_guard<executor_type> work;
+    Handler handler;
+
+    asio::cancellation_signal source_signal;
+
+    // a value that `remaining` active sinks have yet to write
+    struct shared_value
+    {
+        std::shared_ptr<T const> value;
+        std::size_t remaining;
+    };
+
+    // the values from index `first` up to `read_count`; the front is
+    // released once every active sink has written it
+    expanding_circular_buffer<shared_value> window;
+    std::size_t first = 0u, read_count = 0u;
+    // the active sinks that are idle with nothing left to write, and the
+    // sinks, active or not, that are writing
+    std::size_t caught_up = 0u, busy = 0u;
+    bool reading = false, source_done = false, cancelled = false;
+    asio::error_code error;
+
+    void start()
+    {
+        if (active == 0u)
+        {
+            // with no sinks the copy is over at once, but it must not
+            // complete inside the initiating function
+            source_done = true;
+            asio::post(work.get_executor(), [self = this->shared_from_this()] { self->finish(); });
+            return;
+        }
+        if (slot.is_connected())
+            slot.template emplace<canceller>(canceller{this});
+        caught_up = active;
+        step();
+    }
+
+    void read()
+    {
+        if (reading || source_done || caught_up < (std::min)(options.quorum, active))
+            return;
+        reading = true;
+        source(source_handler{{this->shared_from_this()}});
+    }
+
+    void write(std::size_t i)
+    {
+        auto & st = sink_states[i];
+        if (!st.active || st.busy || st.next == read_count)
+            return;
+        st.busy = true;
+        busy++;
+        auto value = window[st.next - first].value;
+        auto & ref = *value;
+        sinks[i](ref, sink_handler{{this->shared_from_this()}, i, std::move(value)});
+    }
+
+    void release()
+    {
+        while (!window.empty() && window.front().remaining == 0u)
+        {
+            window.consume(1u);
+            first++;
+        }
+    }
+
+    void drop(std::size_t i, asio::error_code ec)
+    {
+        auto & st = sink_states[i];
+        st.active = false;
+        st.error = ec;
+        active--;
+        for (auto k = st.next; k != read_count; k++)
+            window[k - first].remaining--;
+        if (st.busy)
+            st.signal.emit(asio::cancellation_type::terminal);
+        else if (st.next == read_count)
+            caught_up--;
+        release();
+
+        if (active == 0u)
+        {
+            // with nobody left to write to, the copy is over; a read in
+            // flight would otherwise hold it open until the source completes
+            source_done = true;
+            if (!error)
+                error = ec;
+            if (reading)
+                source_signal.emit(asio::cancellation_type::terminal);
+        }
+    }
+
+    template<typename U>
+    void on_source(asio::error_code ec, U && value)
+    {
+        reading = false;
+        if (!ec && cancelled)
+            ec = asio::error::operation_aborted;
+
+        if (source_done)
+            ; // the last sink went away while this read was in flight
+        else if (ec)
+        {
+            source_done = true;
+            error = ec;
+        }
+        else
+        {
+            window.push({std::make_shared<T const>(std::forward<U>(value)), active});
+            read_count++;
+            caught_up = 0u;
+            if (read_count - first > options.max_lag)
+                for (std::size_t i = 0u; i < sinks.size(); i++)
+                    if (sink_states[i].active && read_count - sink_states[i].next > options.max_lag)
+                        drop(i, asio::error::no_buffer_space);
+            for (std::size_t i = 0u; i < sinks.size(); i++)
+                write(i);
+        }
+        step();
+    }
+
+    void on_sink(std::size_t i, asio::error_code ec)
+    {
+        auto & st = sink_states[i];
+        st.busy = false;
+        busy--;
+        if (!st.active)
+            ;
+        else if (!ec && cancelled)
+            drop(i, asio::error::operation_aborted);
+        else if (ec)
+            drop(i, ec);
+        else
+        {
+            window[st.next - first].remaining--;
+            if (++st.next == read_count)
+                caught_up++;
+            release();
+            write(i);
+        }
+        step();
+    }
+
+    void step()
+    {
+        read();
+        if (!reading && source_done && busy == 0u && window.empty())
+            finish();
+    }
+
+    void finish()
+    {
+        if (slot.is_connected())
+            slot.clear();
+        if (auto stats = options.stats)
+        {
+            stats->items = read_count;
+            stats->written.clear();
+            stats->errors.clear();
+            for (std::size_t i = 0u; i < sinks.size(); i++)
+            {
+                stats->written.push_back(sink_states[i].next);
+                stats->errors.push_back(sink_states[i].error);
+            }
+        }
+        auto w = std::move(work);
+        auto h = std::move(handler);
+        auto ec = error;
+        auto n = read_count;
+        std::move(h)(ec, n);
+    }
+};
+
+}
+
+/// Copy every value of type `T` that `source` completes with to each of
+/// `sinks`.
+///
+/// The source is invoked as with `async_copy` and must complete with
+/// `(error_code, T)`. Each value is read once and shared. Every sink is
+/// invoked with a `T const &` to it, which stays valid until that sink
+/// completes, and writes the values in order while the other sinks write
+/// concurrently.
+///
+/// The next value is read once `options.quorum` sinks, by default all of
+/// them, have written the last one. A sink that fails, or that falls more
+/// than `options.max_lag` values behind, is dropped and the copy carries on
+/// without it.
+///
+/// The source and sinks are given handlers whose associated executor is the
+/// completion handler's, which defaults to `exec`. The copy counts as work on
+/// it.
+///
+/// The copy ends with the first error from the source, after every sink has
+/// written what was read, or once no sinks are left. Completes with that
+/// error and the number of values read.
+template<typename T, typename Executor, typename SourceOp, typename SinkRange, typename CompletionToken>
+auto async_broadcast_copy(Executor const & exec, SourceOp && source, SinkRange && sinks,
+                          broadcast_copy_options options, CompletionToken && token)
+{
+    using sink_type = std::decay_t<decltype(*std::begin(sinks))>;
+    std::vector<sink_type> ops(std::begin(sinks), std::end(sinks));
+    return asio::async_initiate<CompletionToken, void(std::error_code, std::size_t)>(
+        [exec, options](auto handler, auto && source, std::vector<sink_type> ops)
+        {
+            using state_type = detail::broadcast_copy_state<
+                T, std::decay_t<SourceOp>, sink_type, Executor, decltype(handler)>;
+            std::make_shared<state_type>(
+                exec, std::forward<decltype(source)>(source), std::move(ops),
+                options, std::move(handler))->start();
+        }, token, std::forward<SourceOp>(source), std::move(ops));
+}
+
 }
 
 #endif   // ASIO_EXPERIMENTS_COPY_HPP
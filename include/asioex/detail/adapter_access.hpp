@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_ADAPTER_ACCESS_HPP
+#define ASIOEX_DETAIL_ADAPTER_ACCESS_HPP
+
+namespace asioex
+{
+namespace detail
+{
+/// @brief The way in to the private members of the completion token
+/// adapters, for their async_result and associator specialisations.
+struct adapter_access
+{
+    template < class Token >
+    static decltype(auto)
+    token(Token &t) noexcept
+    {
+        return (t.token_);
+    }
+
+    template < class Token >
+    static auto
+    priority(Token const &t) noexcept
+    {
+        return t.priority_;
+    }
+
+    template < class Adapted >
+    static auto const &
+    handler(Adapted const &h) noexcept
+    {
+        return h.handler_;
+    }
+};
+
+}   // namespace detail
+}   // namespace asioex
+
+#endif   // ASIOEX_DETAIL_ADAPTER_ACCESS_HPP
@@ -19,6 +19,9 @@ struct bilist_node
 
     inline ~bilist_node();
 
+    /// @brief Remove this node from whichever list it is in.
+    /// @details After unlinking the node is self-linked, so unlinking twice
+    /// is harmless.
     inline void
     unlink();
 
@@ -48,6 +51,8 @@ bilist_node::unlink()
     auto n   = next_;
     n->prev_ = p;
     p->next_ = n;
+    next_    = this;
+    prev_    = this;
 }
 
 void
@@ -0,0 +1,282 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_EXPANDING_CIRCULAR_BUFFER_HPP
+#define ASIOEX_DETAIL_EXPANDING_CIRCULAR_BUFFER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace asioex::detail
+{
+/// @brief A FIFO ring buffer which doubles its storage when full.
+/// @details Storage is uninitialized until an element is pushed, so T need
+/// only be move constructible. Capacity is always a power of two, so that
+/// positions wrap with a mask rather than a compare and branch.
+///
+/// If constructed with shrink enabled, the storage is halved once a pop or
+/// consume leaves it no more than one eighth full. After a single pop the
+/// halved buffer is one quarter full, so a burst which grows it is not
+/// immediately followed by a shrink, nor a shrink by a grow.
+template < class T, class Allocator = std::allocator< T > >
+struct expanding_circular_buffer
+{
+    using allocator_type = Allocator;
+    using value_type     = T;
+
+    static constexpr std::size_t initial_capacity = 16;
+
+    expanding_circular_buffer() = default;
+
+    explicit expanding_circular_buffer(
+        bool                  shrink,
+        allocator_type const &alloc = allocator_type())
+    : alloc_(alloc)
+    , shrink_(shrink)
+    {
+    }
+
+    expanding_circular_buffer(expanding_circular_buffer &&other) noexcept
+    : alloc_(std::move(other.alloc_))
+    , shrink_(other.shrink_)
+    , storage_(std::exchange(other.storage_, nullptr))
+    , mask_(std::exchange(other.mask_, 0))
+    , size_(std::exchange(other.size_, 0))
+    , front_pos_(std::exchange(other.front_pos_, 0))
+    {
+    }
+
+    expanding_circular_buffer &
+    operator=(expanding_circular_buffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            if constexpr (traits::propagate_on_container_move_assignment::value)
+                alloc_ = std::move(other.alloc_);
+            else
+                assert(alloc_ == other.alloc_);
+            shrink_    = other.shrink_;
+            storage_   = std::exchange(other.storage_, nullptr);
+            mask_      = std::exchange(other.mask_, 0);
+            size_      = std::exchange(other.size_, 0);
+            front_pos_ = std::exchange(other.front_pos_, 0);
+        }
+        return *this;
+    }
+
+    ~expanding_circular_buffer()
+    {
+        release();
+    }
+
+    void
+    push(T p)
+    {
+        emplace(std::move(p));
+    }
+
+    template < class... Args >
+    T &
+    emplace(Args &&...args)
+    {
+        if (size_ == capacity())
+            reallocate(storage_ ? capacity() * 2 : initial_capacity);
+        auto p = at(front_pos_ + size_);
+        traits::construct(alloc_, p, std::forward< Args >(args)...);
+        size_ += 1;
+        return *p;
+    }
+
+    T
+    pop()
+    {
+        assert(size_);
+        auto p      = at(front_pos_);
+        auto result = std::move(*p);
+        traits::destroy(alloc_, p);
+        front_pos_ = (front_pos_ + 1) & mask_;
+        size_ -= 1;
+        maybe_shrink();
+        return result;
+    }
+
+    T &
+    front()
+    {
+        assert(size_);
+        return *at(front_pos_);
+    }
+
+    /// @brief The element i places behind the front.
+    /// @pre i < size()
+    T &
+    operator[](std::size_t i)
+    {
+        assert(i < size_);
+        return *at(front_pos_ + i);
+    }
+
+    /// @brief The longest run of elements, starting at the front, which is
+    /// contiguous in memory.
+    /// @details Empty only if the buffer is empty. Drain a batch by
+    /// processing this span and then calling consume(span.size()).
+    std::span< T >
+    front_span()
+    {
+        auto n = std::min(size_, capacity() - front_pos_);
+        return { std::to_address(storage_) + front_pos_, n };
+    }
+
+    /// @brief The elements after front_span(), which have wrapped to the
+    /// start of the storage.
+    std::span< T >
+    back_span()
+    {
+        auto n = std::min(size_, capacity() - front_pos_);
+        return { std::to_address(storage_), size_ - n };
+    }
+
+    /// @brief Destroy the first n elements.
+    /// @pre n <= size()
+    void
+    consume(std::size_t n)
+    {
+        assert(n <= size_);
+        for (std::size_t i = 0; i < n; ++i)
+            traits::destroy(alloc_, at(front_pos_ + i));
+        front_pos_ = (front_pos_ + n) & mask_;
+        size_ -= n;
+        maybe_shrink();
+    }
+
+    void
+    clear()
+    {
+        consume(size_);
+    }
+
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    bool
+    empty() const
+    {
+        return size_ == 0;
+    }
+
+    std::size_t
+    capacity() const
+    {
+        return storage_ ? mask_ + 1 : 0;
+    }
+
+    allocator_type
+    get_allocator() const
+    {
+        return alloc_;
+    }
+
+  private:
+    using traits  = std::allocator_traits< Allocator >;
+    using pointer = typename traits::pointer;
+
+    void
+    maybe_shrink()
+    {
+        auto cap = capacity();
+        if (!shrink_ || cap <= initial_capacity || size_ > cap / 8)
+            return;
+
+        // a large consume may allow more than one halving
+        cap /= 2;
+        while (cap > initial_capacity && size_ <= cap / 8)
+            cap /= 2;
+
+        // shrinking is only an optimisation, so a failure is not an error
+        try
+        {
+            reallocate(cap);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    T *
+    at(std::size_t pos) const noexcept
+    {
+        return std::to_address(storage_) + (pos & mask_);
+    }
+
+    void
+    reallocate(std::size_t new_cap)
+    {
+        if (new_cap > traits::max_size(alloc_))
+            throw std::bad_alloc();
+        auto new_storage = traits::allocate(alloc_, new_cap);
+
+        std::size_t moved = 0;
+        try
+        {
+            for (; moved < size_; ++moved)
+                traits::construct(
+                    alloc_,
+                    std::to_address(new_storage) + moved,
+                    std::move_if_noexcept(*at(front_pos_ + moved)));
+        }
+        catch (...)
+        {
+            for (std::size_t i = 0; i < moved; ++i)
+                traits::destroy(alloc_, std::to_address(new_storage) + i);
+            traits::deallocate(alloc_, new_storage, new_cap);
+            throw;
+        }
+
+        auto size = size_;
+        release();
+        storage_   = new_storage;
+        mask_      = new_cap - 1;
+        size_      = size;
+        front_pos_ = 0;
+    }
+
+    void
+    release() noexcept
+    {
+        if (!storage_)
+            return;
+        for (std::size_t i = 0; i < size_; ++i)
+            traits::destroy(alloc_, at(front_pos_ + i));
+        traits::deallocate(alloc_, storage_, capacity());
+        storage_   = nullptr;
+        mask_      = 0;
+        size_      = 0;
+        front_pos_ = 0;
+    }
+
+    [[no_unique_address]] Allocator alloc_  = Allocator();
+    bool                            shrink_ = false;
+    pointer                         storage_   = nullptr;
+    std::size_t                     mask_      = 0;
+    std::size_t                     size_      = 0;
+    std::size_t                     front_pos_ = 0;
+};
+
+}   // namespace asioex::detail
+
+#endif   // ASIOEX_DETAIL_EXPANDING_CIRCULAR_BUFFER_HPP
@@ -16,10 +16,68 @@ namespace asioex
 {
 namespace detail
 {
-semaphore_wait_op::semaphore_wait_op(async_semaphore_base *host)
+template < class Host >
+basic_semaphore_wait_op< Host >::basic_semaphore_wait_op(host_type *host,
+                                                         int requested)
 : host_(host)
+, requested_(requested)
+, dequeued_(false)
+, priority_(0)
+, deadline_(this)
 {
 }
+
+template < class Host >
+void
+semaphore_cancel_handler< Host >::operator()(asio::cancellation_type type)
+{
+    if (!(type & (asio::cancellation_type::terminal |
+                  asio::cancellation_type::partial |
+                  asio::cancellation_type::total)))
+        return;
+
+    // the op may have finished, or be detached from a host which has since
+    // been destroyed and is waiting in a batch to complete
+    if (auto op = op_)
+        if (auto host = op->host_.load(std::memory_order_acquire))
+            host->cancel_waiter(op);
+}
+
+template < class Host >
+semaphore_wait_batch< Host >::semaphore_wait_batch(
+    std::unique_ptr< sized_bilist > ops,
+    error_code                      ec)
+: ops_(std::move(ops))
+, ec_(ec)
+{
+}
+
+template < class Host >
+semaphore_wait_batch< Host >::~semaphore_wait_batch()
+{
+    // the executor was shut down before the batch could run
+    if (ops_)
+        while (!ops_->empty())
+            static_cast< op_type * >(ops_->pop_front())->shutdown();
+}
+
+template < class Host >
+void
+semaphore_wait_batch< Host >::operator()()
+{
+    while (!ops_->empty())
+        static_cast< op_type * >(ops_->pop_front())->invoke(ec_);
+}
+
+template < class Host >
+void
+complete_all(sized_bilist &ops, error_code ec)
+{
+    using op_type = basic_semaphore_wait_op< Host >;
+    while (!ops.empty())
+        static_cast< op_type * >(ops.pop_front())->complete_batch(ops, ec);
+}
+
 }   // namespace detail
 }   // namespace asioex
 
@@ -18,79 +18,177 @@ namespace asioex
 {
 namespace detail
 {
-template < class Executor, class Handler >
-semaphore_wait_op_model< Executor, Handler > *
-semaphore_wait_op_model< Executor, Handler >::construct(
-    async_semaphore_base *host,
-    Executor              e,
-    Handler               handler)
+template < class Executor, class Handler, class Host >
+semaphore_wait_op_model< Executor, Handler, Host > *
+semaphore_wait_op_model< Executor, Handler, Host >::construct(
+    host_type *host,
+    int        requested,
+    Executor   e,
+    Handler    handler)
 {
-    auto halloc = asio::get_associated_allocator(handler);
-    auto alloc  = typename std::allocator_traits< decltype(halloc) >::
-        template rebind_alloc< semaphore_wait_op_model >(halloc);
-    auto traits = std::allocator_traits< decltype(alloc) >();
-    auto pmem   = traits.allocate(alloc, 1);
-    try
+    if constexpr (use_pool())
     {
-        return new (pmem)
-            semaphore_wait_op_model(host, std::move(e), std::move(handler));
+        bool hit;
+        auto pmem = wait_op_pool::local().allocate(hit);
+        host->record_pool_allocation(hit);
+        try
+        {
+            return new (pmem) semaphore_wait_op_model(
+                host, requested, std::move(e), std::move(handler));
+        }
+        catch (...)
+        {
+            wait_op_pool::local().deallocate(pmem);
+            throw;
+        }
     }
-    catch (...)
+    else
     {
-        traits.deallocate(alloc, pmem, 1);
-        throw;
+        host->record_pool_allocation(false);
+        auto halloc = asio::get_associated_allocator(handler);
+        auto alloc  = typename std::allocator_traits< decltype(halloc) >::
+            template rebind_alloc< semaphore_wait_op_model >(halloc);
+        auto traits = std::allocator_traits< decltype(alloc) >();
+        auto pmem   = traits.allocate(alloc, 1);
+        try
+        {
+            return new (pmem) semaphore_wait_op_model(
+                host, requested, std::move(e), std::move(handler));
+        }
+        catch (...)
+        {
+            traits.deallocate(alloc, pmem, 1);
+            throw;
+        }
     }
 }
 
-template < class Executor, class Handler >
+template < class Executor, class Handler, class Host >
 auto
-semaphore_wait_op_model< Executor, Handler >::destroy(
+semaphore_wait_op_model< Executor, Handler, Host >::destroy(
     semaphore_wait_op_model *self) -> void
 {
-    auto halloc = self->get_allocator();
-    auto alloc  = typename std::allocator_traits< decltype(halloc) >::
-        template rebind_alloc< semaphore_wait_op_model >(halloc);
-    std::destroy_at(self);
-    auto traits = std::allocator_traits< decltype(alloc) >();
-    traits.deallocate(alloc, self, 1);
+    if constexpr (use_pool())
+    {
+        std::destroy_at(self);
+        wait_op_pool::local().deallocate(self);
+    }
+    else
+    {
+        auto halloc = self->get_allocator();
+        auto alloc  = typename std::allocator_traits< decltype(halloc) >::
+            template rebind_alloc< semaphore_wait_op_model >(halloc);
+        std::destroy_at(self);
+        auto traits = std::allocator_traits< decltype(alloc) >();
+        traits.deallocate(alloc, self, 1);
+    }
 }
 
-template < class Executor, class Handler >
-semaphore_wait_op_model< Executor, Handler >::semaphore_wait_op_model(
-    async_semaphore_base *host,
-    Executor              e,
-    Handler               handler)
-: semaphore_wait_op(host)
+template < class Executor, class Handler, class Host >
+semaphore_wait_op_model< Executor, Handler, Host >::semaphore_wait_op_model(
+    host_type *host,
+    int        requested,
+    Executor   e,
+    Handler    handler)
+: basic_semaphore_wait_op< Host >(host, requested)
 , work_guard_(std::move(e))
 , handler_(std::move(handler))
 {
     auto slot = get_cancellation_slot();
     if (slot.is_connected())
-        slot.assign(
-            [this](asio::cancellation_type type)
-            {
-                if (!!(type & (asio::cancellation_type::terminal |
-                               asio::cancellation_type::partial |
-                               asio::cancellation_type::total)))
-                {
-                    semaphore_wait_op_model *self = this;
-                    self->complete(asio::error::operation_aborted);
-                }
-            });
+        cancel_handler_ = &slot.template emplace<
+            semaphore_cancel_handler< Host > >(this);
 }
 
-template < class Executor, class Handler >
+template < class Executor, class Handler, class Host >
 void
-semaphore_wait_op_model< Executor, Handler >::complete(error_code ec)
+semaphore_wait_op_model< Executor, Handler, Host >::disarm_cancellation() noexcept
 {
-    get_cancellation_slot().clear();
+    if (cancel_handler_)
+        cancel_handler_->op_ = nullptr;
+}
+
+template < class Executor, class Handler, class Host >
+void
+semaphore_wait_op_model< Executor, Handler, Host >::complete(error_code ec)
+{
+    disarm_cancellation();
     auto g = std::move(work_guard_);
     auto h = std::move(handler_);
-    unlink();
+    this->unlink();
     destroy(this);
     asio::post(g.get_executor(), asio::experimental::append(std::move(h), ec));
 }
 
+template < class Executor, class Handler, class Host >
+void
+semaphore_wait_op_model< Executor, Handler, Host >::complete_batch(
+    sized_bilist &candidates,
+    error_code    ec)
+{
+    using op_type = basic_semaphore_wait_op< Host >;
+
+    auto e     = get_executor();
+    auto batch = std::make_unique< sized_bilist >();
+    batch->splice_back_if(candidates,
+                          [&e](bilist_node *n)
+                          {
+                              auto op = static_cast< op_type * >(n);
+                              if (!op->uses_executor(typeid(Executor), &e))
+                                  return false;
+                              op->host_.store(nullptr, std::memory_order_release);
+                              return true;
+                          });
+
+    if (batch->empty())
+    {
+        complete(ec);
+        return;
+    }
+
+    this->host_.store(nullptr, std::memory_order_release);
+    batch->push_front(this);
+    asio::post(e, semaphore_wait_batch< Host >(std::move(batch), ec));
+}
+
+template < class Executor, class Handler, class Host >
+bool
+semaphore_wait_op_model< Executor, Handler, Host >::uses_executor(
+    std::type_info const &ti,
+    void const           *pe) const
+{
+    return ti == typeid(Executor) &&
+           *static_cast< Executor const * >(pe) == get_executor();
+}
+
+template < class Executor, class Handler, class Host >
+void
+semaphore_wait_op_model< Executor, Handler, Host >::invoke(error_code ec)
+{
+    disarm_cancellation();
+    auto g = std::move(work_guard_);
+    auto h = std::move(handler_);
+    this->unlink();
+    destroy(this);
+    std::move(h)(ec);
+}
+
+template < class Executor, class Handler, class Host >
+void
+semaphore_wait_op_model< Executor, Handler, Host >::shutdown()
+{
+    disarm_cancellation();
+    this->unlink();
+    destroy(this);
+}
+
+template < class Executor, class Handler, class Host >
+bool
+semaphore_wait_op_model< Executor, Handler, Host >::ready()
+{
+    return wait_ready(handler_);
+}
+
 }   // namespace detail
 }   // namespace asioex
 #endif
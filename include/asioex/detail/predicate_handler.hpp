@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_PREDICATE_HANDLER_HPP
+#define ASIOEX_DETAIL_PREDICATE_HANDLER_HPP
+
+#include <asio/associator.hpp>
+
+#include <utility>
+
+namespace asioex
+{
+namespace detail
+{
+/// @brief A completion handler which carries the predicate its waiter is
+/// waiting on, so that a notifier can tell whether waking it is worthwhile.
+template < class Predicate, class Handler >
+struct predicate_handler
+{
+    template < class P, class H >
+    predicate_handler(P &&p, H &&h)
+    : predicate_(std::forward< P >(p))
+    , handler_(std::forward< H >(h))
+    {
+    }
+
+    template < class... Args >
+    void
+    operator()(Args &&...args)
+    {
+        std::move(handler_)(std::forward< Args >(args)...);
+    }
+
+    Predicate predicate_;
+    Handler   handler_;
+};
+
+/// @brief Whether a waiter holding handler h wants to be resumed now.
+/// Plain handlers always do.
+template < class Handler >
+bool
+wait_ready(Handler &)
+{
+    return true;
+}
+
+template < class Predicate, class Handler >
+bool
+wait_ready(predicate_handler< Predicate, Handler > &h)
+{
+    return static_cast< bool >(h.predicate_());
+}
+
+}   // namespace detail
+}   // namespace asioex
+
+namespace asio
+{
+template < template < typename, typename > class Associator,
+           typename Predicate,
+           typename Handler,
+           typename DefaultCandidate >
+struct associator< Associator,
+                   asioex::detail::predicate_handler< Predicate, Handler >,
+                   DefaultCandidate > : Associator< Handler, DefaultCandidate >
+{
+    static typename Associator< Handler, DefaultCandidate >::type
+    get(const asioex::detail::predicate_handler< Predicate, Handler > &h,
+        const DefaultCandidate &c = DefaultCandidate()) ASIO_NOEXCEPT
+    {
+        return Associator< Handler, DefaultCandidate >::get(h.handler_, c);
+    }
+};
+}   // namespace asio
+
+#endif
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_QUEUE_WAIT_HANDLER_HPP
+#define ASIOEX_DETAIL_QUEUE_WAIT_HANDLER_HPP
+
+#include <asio/associator.hpp>
+#include <asioex/detail/predicate_handler.hpp>
+#include <asioex/error_code.hpp>
+
+#include <utility>
+
+namespace asioex
+{
+namespace detail
+{
+/// @brief A completion handler which carries the transfer its waiter is
+/// waiting to make.
+/// @details The queue performs the transfer through wait_ready at the moment
+/// it resumes the waiter, so that items never sit in a completion which has
+/// been posted but not yet run. Action provides `bool ready()`, which attempts
+/// the transfer, and `complete(handler, ec)`, which invokes the handler with
+/// the result.
+template < class Action, class Handler >
+struct queue_wait_handler
+{
+    template < class A, class H >
+    queue_wait_handler(A &&a, H &&h)
+    : action_(std::forward< A >(a))
+    , handler_(std::forward< H >(h))
+    {
+    }
+
+    void
+    operator()(error_code ec)
+    {
+        action_.complete(std::move(handler_), ec);
+    }
+
+    Action  action_;
+    Handler handler_;
+};
+
+template < class Action, class Handler >
+bool
+wait_ready(queue_wait_handler< Action, Handler > &h)
+{
+    return h.action_.ready();
+}
+
+}   // namespace detail
+}   // namespace asioex
+
+namespace asio
+{
+template < template < typename, typename > class Associator,
+           typename Action,
+           typename Handler,
+           typename DefaultCandidate >
+struct associator< Associator,
+                   asioex::detail::queue_wait_handler< Action, Handler >,
+                   DefaultCandidate > : Associator< Handler, DefaultCandidate >
+{
+    static typename Associator< Handler, DefaultCandidate >::type
+    get(const asioex::detail::queue_wait_handler< Action, Handler > &h,
+        const DefaultCandidate &c = DefaultCandidate()) ASIO_NOEXCEPT
+    {
+        return Associator< Handler, DefaultCandidate >::get(h.handler_, c);
+    }
+};
+}   // namespace asio
+
+#endif
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_SEMAPHORE_DEADLINE_TIMER_HPP
+#define ASIOEX_DETAIL_SEMAPHORE_DEADLINE_TIMER_HPP
+
+#include <asio/basic_waitable_timer.hpp>
+#include <asio/wait_traits.hpp>
+#include <asioex/error_code.hpp>
+
+#include <chrono>
+#include <memory>
+
+namespace asioex
+{
+namespace detail
+{
+/// @brief The single timer a semaphore arms for the earliest deadline of its
+/// waiters.
+/// @details The timer is shared with its own pending wait, so it outlives the
+/// semaphore if need be. The semaphore detaches itself on destruction by
+/// clearing host_.
+template < class Host >
+struct semaphore_deadline_timer
+{
+    using clock_type = std::chrono::steady_clock;
+
+    explicit semaphore_deadline_timer(Host *host)
+    : host_(host)
+    , armed_(clock_type::time_point::max())
+    {
+    }
+
+    virtual ~semaphore_deadline_timer() = default;
+
+    /// @brief Make sure the timer fires no later than when.
+    virtual void
+    arm(clock_type::time_point when) = 0;
+
+    /// @brief Stop the timer, there are no deadlines left.
+    virtual void
+    disarm() = 0;
+
+    Host                  *host_;
+    clock_type::time_point armed_;
+};
+
+template < class Host, class Executor >
+struct semaphore_deadline_timer_impl final
+: semaphore_deadline_timer< Host >
+, std::enable_shared_from_this< semaphore_deadline_timer_impl< Host, Executor > >
+{
+    using clock_type = std::chrono::steady_clock;
+    using timer_type = asio::basic_waitable_timer< clock_type,
+                                                   asio::wait_traits< clock_type >,
+                                                   Executor >;
+
+    semaphore_deadline_timer_impl(Host *host, Executor const &exec)
+    : semaphore_deadline_timer< Host >(host)
+    , timer_(exec)
+    {
+    }
+
+    void
+    arm(clock_type::time_point when) override
+    {
+        if (when >= this->armed_)
+            return;
+
+        // re-arming aborts the wait in progress, whose handler then does
+        // nothing
+        this->armed_ = when;
+        timer_.expires_at(when);
+        timer_.async_wait(
+            [self = this->shared_from_this()](error_code ec)
+            {
+                if (ec || !self->host_)
+                    return;
+                self->armed_ = clock_type::time_point::max();
+                self->host_->expire_waiters(clock_type::now());
+            });
+    }
+
+    void
+    disarm() override
+    {
+        if (this->armed_ == clock_type::time_point::max())
+            return;
+        this->armed_ = clock_type::time_point::max();
+        timer_.cancel();
+    }
+
+  private:
+    timer_type timer_;
+};
+
+}   // namespace detail
+}   // namespace asioex
+
+#endif
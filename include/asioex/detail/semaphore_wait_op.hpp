@@ -10,8 +10,16 @@
 #ifndef ASIOEX_DETAIL_SEMAPHORE_WAIT_OP
 #define ASIOEX_DETAIL_SEMAPHORE_WAIT_OP
 
+#include <asio/cancellation_type.hpp>
 #include <asioex/detail/bilist_node.hpp>
+#include <asioex/detail/sized_bilist.hpp>
 #include <asioex/error_code.hpp>
+#include <asioex/wait_priority.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <typeinfo>
 
 namespace asioex
 {
@@ -19,18 +27,133 @@ struct async_semaphore_base;
 
 namespace detail
 {
-struct semaphore_wait_op : detail::bilist_node
+/// @brief Orders a waiter by deadline, independently of its place in the
+/// wait queue. A waiter without a deadline is never linked.
+template < class Op >
+struct semaphore_deadline_link : bilist_node
+{
+    explicit semaphore_deadline_link(Op *op)
+    : op_(op)
+    , when_()
+    {
+    }
+
+    Op                                   *op_;
+    std::chrono::steady_clock::time_point when_;
+};
+
+/// @brief The type-erased part of a pending async_acquire.
+/// @tparam Host is the semaphore type which owns the wait list. Cancellation
+/// of a waiter is routed through `Host::cancel_waiter` so that a
+/// multi-threaded host can take its lock before touching the list.
+template < class Host >
+struct basic_semaphore_wait_op : detail::bilist_node
 {
-    semaphore_wait_op(async_semaphore_base *host);
+    using host_type = Host;
+
+    basic_semaphore_wait_op(host_type *host, int requested);
 
+    /// @brief Post the completion of this op on its own.
     virtual void complete(error_code) = 0;
 
-    async_semaphore_base *host_;
+    /// @brief Complete this op together with every op in candidates which
+    /// shares its executor, using a single posted work item.
+    /// @pre this op has been removed from its host's wait list
+    virtual void
+    complete_batch(sized_bilist &candidates, error_code ec) = 0;
+
+    /// @brief Test whether this op's executor has type ti and compares equal
+    /// to the executor pointed to by pe.
+    virtual bool
+    uses_executor(std::type_info const &ti, void const *pe) const = 0;
+
+    /// @brief Destroy this op and invoke its handler inline.
+    /// @pre The caller is running in the op's associated executor.
+    virtual void
+    invoke(error_code ec) = 0;
+
+    /// @brief Destroy this op without invoking its handler.
+    virtual void
+    shutdown() = 0;
+
+    /// @brief Whether the waiter wants to be resumed now. Waits on a
+    /// condition variable may carry a predicate which is evaluated here.
+    virtual bool
+    ready() = 0;
+
+    /// @brief The host, or nullptr once the op has been detached from the
+    /// host for batched completion and may no longer be cancelled.
+    /// @details Atomic because a multi-threaded host detaches ops outside
+    /// its lock, while a cancellation may be reading this on another thread.
+    std::atomic< host_type * > host_;
+
+    /// @brief The number of units this op is waiting for.
+    int requested_;
+
+    /// @brief Set, under the host's lock, by a host which takes ops off its
+    /// wait list to complete them outside the lock, so that a cancellation
+    /// arriving meanwhile from another thread can tell that the op has left.
+    bool dequeued_;
+
+    /// @brief The rank of this op under priority_wait_queue.
+    wait_priority priority_;
+
+    /// @brief The op's place in its host's deadline list, if it has one.
+    semaphore_deadline_link< basic_semaphore_wait_op > deadline_;
 };
 
+using semaphore_wait_op = basic_semaphore_wait_op< async_semaphore_base >;
+
+/// @brief The handler a wait op installs in its cancellation slot.
+/// @details It is a single pointer, so it fits the memory the slot kept from
+/// its previous handler. When the op finishes it disarms the handler in place
+/// rather than clearing the slot, which would free that memory only for the
+/// next wait on the same slot to allocate it again.
+template < class Host >
+struct semaphore_cancel_handler
+{
+    explicit semaphore_cancel_handler(basic_semaphore_wait_op< Host > *op)
+    : op_(op)
+    {
+    }
+
+    void
+    operator()(asio::cancellation_type type);
+
+    /// @brief The op to cancel, or nullptr once it has finished.
+    basic_semaphore_wait_op< Host > *op_;
+};
+
+/// @brief A work item which invokes a list of ops, in order, on the
+/// executor they share.
+template < class Host >
+struct semaphore_wait_batch
+{
+    using op_type = basic_semaphore_wait_op< Host >;
+
+    semaphore_wait_batch(std::unique_ptr< sized_bilist > ops, error_code ec);
+
+    semaphore_wait_batch(semaphore_wait_batch &&) = default;
+
+    ~semaphore_wait_batch();
+
+    void
+    operator()();
+
+  private:
+    std::unique_ptr< sized_bilist > ops_;
+    error_code                      ec_;
+};
+
+/// @brief Complete every op in ops, posting one work item per distinct
+/// executor rather than one per op.
+template < class Host >
+void
+complete_all(sized_bilist &ops, error_code ec);
+
 }   // namespace detail
 }   // namespace asioex
 
 #endif
 
-#include <asioex/detail/impl/semaphore_wait_op.hpp>
\ No newline at end of file
+#include <asioex/detail/impl/semaphore_wait_op.hpp>
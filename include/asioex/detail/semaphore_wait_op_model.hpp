@@ -13,16 +13,21 @@
 #include <asio/associated_allocator.hpp>
 #include <asio/associated_cancellation_slot.hpp>
 #include <asio/executor_work_guard.hpp>
+#include <asioex/detail/predicate_handler.hpp>
 #include <asioex/detail/semaphore_wait_op.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
 #include <asioex/error_code.hpp>
 
 namespace asioex
 {
 namespace detail
 {
-template < class Executor, class Handler >
-struct semaphore_wait_op_model final : semaphore_wait_op
+template < class Executor,
+           class Handler,
+           class Host = async_semaphore_base >
+struct semaphore_wait_op_model final : basic_semaphore_wait_op< Host >
 {
+    using host_type     = Host;
     using executor_type = Executor;
     using cancellation_slot_type =
         asio::associated_cancellation_slot_t< Handler >;
@@ -41,35 +46,57 @@ struct semaphore_wait_op_model final : semaphore_wait_op
     }
 
     executor_type
-    get_executor()
+    get_executor() const
     {
         return work_guard_.get_executor();
     }
 
     static semaphore_wait_op_model *
-    construct(async_semaphore_base *host, Executor e, Handler handler);
+    construct(host_type *host, int requested, Executor e, Handler handler);
 
     static void
     destroy(semaphore_wait_op_model *self);
 
-    semaphore_wait_op_model(async_semaphore_base *host,
-                            Executor              e,
-                            Handler               handler);
+    semaphore_wait_op_model(host_type *host,
+                            int        requested,
+                            Executor   e,
+                            Handler    handler);
 
     virtual void
     complete(error_code ec) override;
 
-  private:
-    struct cancellation_handler
-    {
-        semaphore_wait_op_model* self;
+    virtual void
+    complete_batch(sized_bilist &candidates, error_code ec) override;
 
-        void operator()(asio::cancellation_type type);
-    };
+    virtual bool
+    uses_executor(std::type_info const &ti, void const *pe) const override;
+
+    virtual void
+    invoke(error_code ec) override;
+
+    virtual void
+    shutdown() override;
+
+    virtual bool
+    ready() override;
 
   private:
+    /// @brief Stop the cancellation handler from reaching this op.
+    void
+    disarm_cancellation() noexcept;
+
+    // handlers without a custom allocator are served from the per-thread
+    // pool, everything else uses the associated allocator
+    static constexpr bool
+    use_pool()
+    {
+        return wait_op_pool::eligible< semaphore_wait_op_model,
+                                       allocator_type >;
+    }
+
     asio::executor_work_guard< Executor > work_guard_;
     Handler                               handler_;
+    semaphore_cancel_handler< Host >     *cancel_handler_ = nullptr;
 };
 
 }   // namespace detail
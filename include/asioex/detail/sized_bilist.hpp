@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_SIZED_BILIST_HPP
+#define ASIOEX_DETAIL_SIZED_BILIST_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/bilist_node.hpp>
+
+#include <cstddef>
+
+namespace asioex
+{
+namespace detail
+{
+/// @brief An intrusive list of bilist_node which maintains its own length.
+/// @details All nodes must be inserted and removed through the list so that
+/// size() stays accurate. Every operation, including size(), is O(1).
+struct sized_bilist
+{
+    inline sized_bilist();
+
+    sized_bilist(sized_bilist const &) ASIO_DELETED;
+
+    sized_bilist &
+    operator=(sized_bilist const &) ASIO_DELETED;
+
+    ASIO_NODISCARD inline bool
+    empty() const noexcept;
+
+    ASIO_NODISCARD inline std::size_t
+    size() const noexcept;
+
+    /// @pre !empty()
+    ASIO_NODISCARD inline bilist_node *
+    front() const noexcept;
+
+    /// @pre !empty()
+    ASIO_NODISCARD inline bilist_node *
+    back() const noexcept;
+
+    /// @brief The sentinel which terminates a traversal from front().
+    ASIO_NODISCARD inline bilist_node const *
+    end() const noexcept;
+
+    inline void
+    push_back(bilist_node *node) noexcept;
+
+    inline void
+    push_front(bilist_node *node) noexcept;
+
+    /// @brief Insert node before pos.
+    /// @pre pos is an element of this list
+    inline void
+    insert(bilist_node *pos, bilist_node *node) noexcept;
+
+    /// @brief Insert node ahead of the trailing run of elements for which
+    /// pred returns true.
+    /// @details The scan starts at the back. On a list ordered by key, with
+    /// pred testing whether an element's key is greater than node's, this is
+    /// a stable ordered insert which costs O(1) when keys arrive in order.
+    template < class Pred >
+    void
+    insert_before_trailing(bilist_node *node, Pred pred);
+
+    /// @pre !empty()
+    inline bilist_node *
+    pop_front() noexcept;
+
+    /// @pre node is an element of this list
+    inline void
+    erase(bilist_node *node) noexcept;
+
+    /// @brief Move every element of other to the back of this list.
+    inline void
+    splice_back(sized_bilist &other) noexcept;
+
+    /// @brief Move the elements of other for which pred returns true to the
+    /// back of this list, preserving their order.
+    template < class Pred >
+    void
+    splice_back_if(sized_bilist &other, Pred pred);
+
+  private:
+    bilist_node head_;
+    std::size_t size_;
+};
+
+sized_bilist::sized_bilist()
+: head_()
+, size_(0)
+{
+}
+
+bool
+sized_bilist::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+std::size_t
+sized_bilist::size() const noexcept
+{
+    return size_;
+}
+
+bilist_node *
+sized_bilist::front() const noexcept
+{
+    ASIO_ASSERT(!empty());
+    return head_.next_;
+}
+
+bilist_node *
+sized_bilist::back() const noexcept
+{
+    ASIO_ASSERT(!empty());
+    return head_.prev_;
+}
+
+bilist_node const *
+sized_bilist::end() const noexcept
+{
+    return &head_;
+}
+
+void
+sized_bilist::push_back(bilist_node *node) noexcept
+{
+    node->link_before(&head_);
+    ++size_;
+}
+
+void
+sized_bilist::push_front(bilist_node *node) noexcept
+{
+    node->link_before(head_.next_);
+    ++size_;
+}
+
+void
+sized_bilist::insert(bilist_node *pos, bilist_node *node) noexcept
+{
+    node->link_before(pos);
+    ++size_;
+}
+
+template < class Pred >
+void
+sized_bilist::insert_before_trailing(bilist_node *node, Pred pred)
+{
+    bilist_node *pos = &head_;
+    while (pos->prev_ != &head_ && pred(pos->prev_))
+        pos = pos->prev_;
+    insert(pos, node);
+}
+
+bilist_node *
+sized_bilist::pop_front() noexcept
+{
+    auto node = front();
+    erase(node);
+    return node;
+}
+
+void
+sized_bilist::erase(bilist_node *node) noexcept
+{
+    ASIO_ASSERT(size_ > 0);
+    node->unlink();
+    --size_;
+}
+
+void
+sized_bilist::splice_back(sized_bilist &other) noexcept
+{
+    if (other.empty())
+        return;
+
+    auto first = other.head_.next_;
+    auto last  = other.head_.prev_;
+
+    first->prev_       = head_.prev_;
+    head_.prev_->next_ = first;
+    last->next_        = &head_;
+    head_.prev_        = last;
+
+    size_ += other.size_;
+
+    other.head_.next_ = &other.head_;
+    other.head_.prev_ = &other.head_;
+    other.size_       = 0;
+}
+
+template < class Pred >
+void
+sized_bilist::splice_back_if(sized_bilist &other, Pred pred)
+{
+    auto n = other.head_.next_;
+    while (n != &other.head_)
+    {
+        auto next = n->next_;
+        if (pred(n))
+        {
+            other.erase(n);
+            push_back(n);
+        }
+        n = next;
+    }
+}
+
+}   // namespace detail
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_SPSC_RING_HPP
+#define ASIOEX_DETAIL_SPSC_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace asioex::detail
+{
+/// @brief A fixed capacity, lock-free ring for exactly one producer thread
+/// and one consumer thread.
+/// @details The producer owns the tail index and the consumer owns the head.
+/// Each lives on its own cache line next to a cached copy of the other
+/// side's index, so that the opposite line is only read when the cached
+/// copy says the ring looks full (or empty). The batch functions move as
+/// many items as fit and then publish them with a single store.
+///
+/// Indices increase without wrapping back, and the capacity is a power of
+/// two, so that a slot is found with a mask.
+template < class T >
+struct spsc_ring
+{
+    /// @brief The assumed size of a cache line.
+    static constexpr std::size_t cache_line = 64;
+
+    /// @param capacity is rounded up to a power of two.
+    /// @pre capacity > 0
+    explicit spsc_ring(std::size_t capacity)
+    : shared_ { std::bit_ceil(capacity) - 1,
+                std::allocator< T >().allocate(std::bit_ceil(capacity)) }
+    {
+        assert(capacity > 0);
+    }
+
+    spsc_ring(spsc_ring const &) = delete;
+
+    spsc_ring &
+    operator=(spsc_ring const &) = delete;
+
+    ~spsc_ring()
+    {
+        auto head = consumer_.head.load(std::memory_order_relaxed);
+        auto tail = producer_.tail.load(std::memory_order_relaxed);
+        for (; head != tail; ++head)
+            std::destroy_at(slot(head));
+        std::allocator< T >().deallocate(shared_.storage, capacity());
+    }
+
+    /// @brief Producer: push value if there is room.
+    /// @returns true if value was pushed. value is only moved from if so.
+    bool
+    try_push(T &&value)
+    {
+        return try_push_some(std::span< T >(&value, 1)) == 1;
+    }
+
+    /// @brief Producer: move as many items from the front of in as there is
+    /// room for, and publish them together.
+    /// @returns The number of items pushed.
+    std::size_t
+    try_push_some(std::span< T > in)
+    {
+        auto tail = producer_.tail.load(std::memory_order_relaxed);
+        auto room = capacity() - (tail - producer_.cached_head);
+        if (room < in.size())
+        {
+            producer_.cached_head =
+                consumer_.head.load(std::memory_order_acquire);
+            room = capacity() - (tail - producer_.cached_head);
+        }
+
+        auto n = std::min(room, in.size());
+        for (std::size_t i = 0; i < n; ++i)
+            std::construct_at(slot(tail + i), std::move(in[i]));
+        if (n)
+            producer_.tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// @brief Consumer: pop the front item into value if there is one.
+    bool
+    try_pop(T &value)
+    {
+        return try_pop_some(std::span< T >(&value, 1)) == 1;
+    }
+
+    /// @brief Consumer: move as many items as are available, up to
+    /// out.size(), into out, and release their slots together.
+    /// @returns The number of items popped.
+    std::size_t
+    try_pop_some(std::span< T > out)
+    {
+        auto head  = consumer_.head.load(std::memory_order_relaxed);
+        auto avail = consumer_.cached_tail - head;
+        if (avail < out.size())
+        {
+            consumer_.cached_tail =
+                producer_.tail.load(std::memory_order_acquire);
+            avail = consumer_.cached_tail - head;
+        }
+
+        auto n = std::min(avail, out.size());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto p = slot(head + i);
+            out[i] = std::move(*p);
+            std::destroy_at(p);
+        }
+        if (n)
+            consumer_.head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// @brief Whether the ring holds no items, as last published.
+    /// @details If the consumer sees false, its next pop succeeds.
+    bool
+    empty() const noexcept
+    {
+        return consumer_.head.load(std::memory_order_acquire) ==
+               producer_.tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t
+    capacity() const noexcept
+    {
+        return shared_.mask + 1;
+    }
+
+  private:
+    T *
+    slot(std::size_t index) const noexcept
+    {
+        return shared_.storage + (index & shared_.mask);
+    }
+
+    struct alignas(cache_line) shared_side
+    {
+        std::size_t mask;
+        T          *storage;
+    };
+
+    struct alignas(cache_line) producer_side
+    {
+        std::atomic< std::size_t > tail { 0 };
+        std::size_t                cached_head = 0;
+    };
+
+    struct alignas(cache_line) consumer_side
+    {
+        std::atomic< std::size_t > head { 0 };
+        std::size_t                cached_tail = 0;
+    };
+
+    shared_side   shared_;
+    producer_side producer_;
+    consumer_side consumer_;
+};
+
+}   // namespace asioex::detail
+
+#endif   // ASIOEX_DETAIL_SPSC_RING_HPP
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_DETAIL_WAIT_OP_POOL_HPP
+#define ASIOEX_DETAIL_WAIT_OP_POOL_HPP
+
+#include <asio/detail/config.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace asioex
+{
+/// @brief Counts of wait op allocations served by the per-thread pool
+/// (hits) and by a fresh allocation (misses).
+struct wait_op_pool_stats
+{
+    std::size_t hits   = 0;
+    std::size_t misses = 0;
+};
+
+namespace detail
+{
+/// @brief A per-thread free list of fixed size blocks for wait ops.
+/// @details The pool is per-thread rather than per-semaphore because a wait
+/// op may outlive its semaphore, for example when the semaphore's destructor
+/// posts the aborted completions. A block may be returned to a different
+/// thread's pool than the one it came from.
+struct wait_op_pool
+{
+    static constexpr std::size_t block_size = 256;
+    static constexpr std::size_t max_cached = 1024;
+
+    /// @brief Test whether objects of type T, allocated through allocator
+    /// Alloc, are served by the pool.
+    template < class T, class Alloc >
+    static constexpr bool eligible =
+        sizeof(T) <= block_size &&
+        alignof(T) <= alignof(std::max_align_t) &&
+        std::is_same_v< Alloc, std::allocator< void > >;
+
+    static inline wait_op_pool &
+    local();
+
+    wait_op_pool() = default;
+
+    wait_op_pool(wait_op_pool const &) ASIO_DELETED;
+
+    wait_op_pool &
+    operator=(wait_op_pool const &) ASIO_DELETED;
+
+    inline ~wait_op_pool();
+
+    /// @brief Allocate one block.
+    /// @param hit is set to true if the block came from the free list.
+    inline void *
+    allocate(bool &hit);
+
+    inline void
+    deallocate(void *p) noexcept;
+
+  private:
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    free_block *free_   = nullptr;
+    std::size_t cached_ = 0;
+};
+
+wait_op_pool &
+wait_op_pool::local()
+{
+    static thread_local wait_op_pool pool;
+    return pool;
+}
+
+wait_op_pool::~wait_op_pool()
+{
+    while (free_)
+        ::operator delete(std::exchange(free_, free_->next));
+}
+
+void *
+wait_op_pool::allocate(bool &hit)
+{
+    hit = free_ != nullptr;
+    if (!hit)
+        return ::operator new(block_size);
+
+    --cached_;
+    return std::exchange(free_, free_->next);
+}
+
+void
+wait_op_pool::deallocate(void *p) noexcept
+{
+    if (cached_ == max_cached)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    ++cached_;
+    free_ = ::new (p) free_block { free_ };
+}
+
+}   // namespace detail
+}   // namespace asioex
+
+#endif
@@ -8,35 +8,57 @@
 #include <asioex/redirect_cancellation.hpp>
 #include <asio/experimental/basic_channel.hpp>
 #include <asio/experimental/coro.hpp>
+#include <asio/experimental/deferred.hpp>
+#include <asio/post.hpp>
+#include <asio/this_coro.hpp>
 #include <asio/use_awaitable.hpp>
 
+#include <exception>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
 namespace asioex
 {
 
 template<typename ...Ts>
 struct range_from_channel;
 
+// wait() returns the awaitable of the receive itself, with the value stored
+// by a deferred continuation, so that an iteration does not need a coroutine
+// frame of its own. Cancellation is checked by co_for.
 template<typename Executor, typename Traits, typename Error, typename T>
 struct range_from_channel<Executor, Traits, void(Error, T)>
 {
     asio::experimental::basic_channel<Executor, Traits, void(Error, T)> & chan;
 
-
     template<typename Exec>
-    asio::awaitable<bool> wait(asio::use_awaitable_t<Exec>)
+    asio::awaitable<bool, Exec> wait(asio::use_awaitable_t<Exec> token)
     {
-        if ((co_await asio::this_coro::cancellation_state).cancelled() != asio::cancellation_type::none
-               || !chan.is_open())
-            co_return false;
+        using asio::experimental::deferred;
+        if (!chan.is_open())
+            return asio::post(chan.get_executor(),
+                              deferred([]{ return deferred.values(Error{}, false); }))(token);
+
+        return chan.async_receive(
+                deferred([this](Error ec, T value)
+                {
+                    if (!ec)
+                        store(std::move(value));
+                    return deferred.values(ec, !ec);
+                }))(token);
+    }
 
+    void store(T && value)
+    {
         if (has_value)
-            init() = co_await chan.async_receive(asio::use_awaitable);
+            init() = std::move(value);
         else
         {
+            new (&storage_) T(std::move(value));
             has_value = true;
-            new (&storage_) T(co_await chan.async_receive(asio::use_awaitable));
         }
-        co_return true;
     }
 
     T& init()
@@ -63,32 +85,120 @@ auto range_from(asio::experimental::basic_channel<Ts...> & chan)
 
 
 
+template<typename ...Ts>
+struct range_from_channel_batch;
+
+// Like range_from_channel, but after each receive takes whatever else the
+// channel has ready with try_receive, so that a resumption can yield a batch.
+// An error met while doing so is kept for the next wait().
+template<typename Executor, typename Traits, typename Error, typename T>
+struct range_from_channel_batch<Executor, Traits, void(Error, T)>
+{
+    asio::experimental::basic_channel<Executor, Traits, void(Error, T)> & chan;
+    std::span<T> buffer;
+    std::span<T> batch = {};
+    Error pending = {};
+
+    template<typename Exec>
+    asio::awaitable<bool, Exec> wait(asio::use_awaitable_t<Exec> token)
+    {
+        using asio::experimental::deferred;
+        if (pending || !chan.is_open())
+            return asio::post(chan.get_executor(),
+                              deferred([ec = std::exchange(pending, Error{})]
+                                       {
+                                           return deferred.values(ec, false);
+                                       }))(token);
+
+        return chan.async_receive(
+                deferred([this](Error ec, T value)
+                {
+                    if (!ec)
+                        drain(std::move(value));
+                    return deferred.values(ec, !ec);
+                }))(token);
+    }
+
+    void drain(T && first)
+    {
+        buffer[0] = std::move(first);
+        std::size_t n = 1u;
+        auto take = [&](Error ec, T value)
+        {
+            if (ec)
+                pending = ec;
+            else
+                buffer[n++] = std::move(value);
+        };
+        while (!pending && n < buffer.size() && chan.try_receive(take))
+            ;
+        batch = buffer.first(n);
+    }
+
+    std::span<T>& init()
+    {
+        return batch;
+    }
+};
+
+/// Receive from `chan` into `buffer`, a span or a contiguous container with
+/// room for at least one item, for use with co_for_batch. Throws
+/// `std::invalid_argument` if `buffer` is empty.
+template<typename Buffer, typename ...Ts>
+auto range_from(asio::experimental::basic_channel<Ts...> & chan, Buffer & buffer)
+{
+    range_from_channel_batch<Ts...> range{chan, buffer};
+    if (range.buffer.empty())
+        throw std::invalid_argument("asioex::range_from: the batch buffer is empty");
+    return range;
+}
+
 template<typename Yield, typename Executor>
 struct range_from_coro
 {
     asio::experimental::coro<Yield, void, Executor> & coro;
     using value_type = typename asio::experimental::coro<Yield, void, Executor>::yield_type;
 
+    // stores the yielded value, if any, and passes on whether there was one
+    struct resumed
+    {
+        range_from_coro * range;
+
+        auto operator()(std::optional<value_type> value)
+        {
+            return asio::experimental::deferred.values(range->store(std::move(value)));
+        }
+
+        auto operator()(std::exception_ptr ex, std::optional<value_type> value)
+        {
+            return asio::experimental::deferred.values(ex, range->store(std::move(value)));
+        }
+    };
+
     template<typename Exec>
-    asio::awaitable<bool> wait(asio::use_awaitable_t<Exec>)
+    asio::awaitable<bool, Exec> wait(asio::use_awaitable_t<Exec> token)
     {
-        if ((co_await asio::this_coro::cancellation_state).cancelled() != asio::cancellation_type::none
-               || !coro.is_open())
-            co_return false;
+        using asio::experimental::deferred;
+        if (!coro.is_open())
+            return asio::post(coro.get_executor(),
+                              deferred([]{ return deferred.values(false); }))(token);
+
+        return coro.async_resume(deferred(resumed{this}))(token);
+    }
 
-        auto value = co_await coro.async_resume(asio::use_awaitable);
+    bool store(std::optional<value_type> value)
+    {
         if (!value)
-            co_return false;
+            return false;
 
         if (has_value)
             init() = std::move(*value);
         else
         {
-            has_value = true;
             new (&storage_) value_type(std::move(*value));
+            has_value = true;
         }
-
-        co_return true;
+        return true;
     }
 
     value_type& init()
@@ -116,7 +226,17 @@ auto range_from(asio::experimental::coro<Yield, void, Executor> & coro)
 #define co_for(Var, Src, Token) \
     if (auto r = asioex::range_from(Src); true)   \
         for (auto & Var = r.init(); \
-             co_await r.wait(Token);)
+             (co_await asio::this_coro::cancellation_state).cancelled() == asio::cancellation_type::none \
+                && co_await r.wait(Token);)
+
+/// Loop over a channel a batch at a time. `Var` is a std::span of the items
+/// received into `Buffer` since the last iteration: the first one the loop
+/// waited for and whatever the channel had ready after it.
+#define co_for_batch(Var, Buffer, Src, Token) \
+    if (auto r = asioex::range_from(Src, Buffer); true)   \
+        for (auto & Var = r.init(); \
+             (co_await asio::this_coro::cancellation_state).cancelled() == asio::cancellation_type::none \
+                && co_await r.wait(Token);)
 }
 
 
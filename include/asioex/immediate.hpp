@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMMEDIATE_HPP
+#define ASIOEX_IMMEDIATE_HPP
+
+#include <asio/associator.hpp>
+#include <asio/async_result.hpp>
+#include <asio/dispatch.hpp>
+#include <asio/experimental/append.hpp>
+#include <asio/post.hpp>
+#include <asioex/associated_immediacy.hpp>
+#include <asioex/detail/adapter_access.hpp>
+#include <asioex/wait_priority.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace asioex
+{
+
+/// A completion token adapter which allows an operation that can complete
+/// without waiting to invoke the handler inline.
+///
+/// Operations which support it (e.g. async_semaphore::async_acquire) complete
+/// as if by `dispatch` rather than `post` when the result is available at
+/// initiation. The handler therefore runs inline if its associated executor is
+/// running in the current thread. Nested inline completions on one thread are
+/// limited to detail::immediate_max_depth, after which completion falls back
+/// to `post` so that a loop of immediate operations cannot overflow the stack.
+template <typename CompletionToken>
+class immediate_t
+{
+  public:
+    /// Constructor.
+    template <typename T>
+    explicit immediate_t(ASIO_MOVE_ARG(T) completion_token)
+        : token_(ASIO_MOVE_CAST(T)(completion_token))
+    {
+    }
+
+  private:
+    friend struct detail::adapter_access;
+
+    CompletionToken token_;
+};
+
+/// Adapt a @ref completion_token to allow inline completion.
+template <typename CompletionToken>
+inline immediate_t<typename std::decay<CompletionToken>::type> immediate(
+    ASIO_MOVE_ARG(CompletionToken) completion_token)
+{
+    return immediate_t<typename std::decay<CompletionToken>::type>(
+        ASIO_MOVE_CAST(CompletionToken)(completion_token));
+}
+
+namespace detail {
+
+// Class to adapt an immediate_t as a completion handler.
+template <typename Handler>
+class immediate_handler
+{
+  public:
+    typedef void result_type;
+
+    template <typename RedirectedHandler>
+    explicit immediate_handler(ASIO_MOVE_ARG(RedirectedHandler) h)
+    : handler_(ASIO_MOVE_CAST(RedirectedHandler)(h))
+    {
+    }
+
+    template <typename... Args>
+    void operator()(ASIO_MOVE_ARG(Args)... args)
+    {
+        ASIO_MOVE_OR_LVALUE(Handler)(handler_)(ASIO_MOVE_CAST(Args)(args)...);
+    }
+
+    bool get_immediacy() const noexcept
+    {
+        return true;
+    }
+
+    wait_priority get_wait_priority() const noexcept
+    {
+        return get_associated_wait_priority(handler_);
+    }
+
+  private:
+    friend struct detail::adapter_access;
+
+    Handler handler_;
+};
+
+constexpr std::size_t immediate_max_depth = 16;
+
+inline std::size_t &
+immediate_depth()
+{
+    static thread_local std::size_t depth = 0;
+    return depth;
+}
+
+/// Deliver the result of an operation which completed at initiation.
+/// Handlers adapted with asioex::immediate, however deeply wrapped, are
+/// dispatched, subject to the nesting limit, everything else is posted.
+template <typename Executor, typename Handler, typename... Args>
+void complete_now(const Executor & ex,
+                  ASIO_MOVE_ARG(Handler) handler,
+                  ASIO_MOVE_ARG(Args)... args)
+{
+    if (get_associated_immediacy(handler))
+    {
+        auto & depth = immediate_depth();
+        if (depth < immediate_max_depth)
+        {
+            struct depth_guard
+            {
+                std::size_t & depth;
+                ~depth_guard() { --depth; }
+            } guard{++depth};
+
+            asio::dispatch(ex,
+                           asio::experimental::append(
+                               ASIO_MOVE_CAST(Handler)(handler),
+                               ASIO_MOVE_CAST(Args)(args)...));
+            return;
+        }
+    }
+
+    asio::post(ex,
+               asio::experimental::append(ASIO_MOVE_CAST(Handler)(handler),
+                                          ASIO_MOVE_CAST(Args)(args)...));
+}
+
+} // namespace detail
+}
+
+namespace asio {
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename CompletionToken, typename Signature>
+struct async_result<asioex::immediate_t<CompletionToken>, Signature>
+{
+    typedef typename async_result<CompletionToken, Signature>
+        ::return_type return_type;
+
+    template <typename Initiation>
+    struct init_wrapper
+    {
+        template <typename Init>
+        explicit init_wrapper(ASIO_MOVE_ARG(Init) init)
+        : initiation_(ASIO_MOVE_CAST(Init)(init))
+        {
+        }
+
+        template <typename Handler, typename... Args>
+        void operator()(
+            ASIO_MOVE_ARG(Handler) handler,
+            ASIO_MOVE_ARG(Args)... args)
+        {
+            ASIO_MOVE_CAST(Initiation)(initiation_)(
+                asioex::detail::immediate_handler<
+                    typename decay<Handler>::type>(
+                    ASIO_MOVE_CAST(Handler)(handler)),
+                ASIO_MOVE_CAST(Args)(args)...);
+        }
+
+        Initiation initiation_;
+    };
+
+    template <typename Initiation, typename RawCompletionToken, typename... Args>
+    static return_type initiate(
+        ASIO_MOVE_ARG(Initiation) initiation,
+        ASIO_MOVE_ARG(RawCompletionToken) token,
+        ASIO_MOVE_ARG(Args)... args)
+    {
+        return async_initiate<CompletionToken, Signature>(
+            init_wrapper<typename decay<Initiation>::type>(
+                ASIO_MOVE_CAST(Initiation)(initiation)),
+            asioex::detail::adapter_access::token(token),
+            ASIO_MOVE_CAST(Args)(args)...);
+    }
+};
+
+template <template <typename, typename> class Associator,
+           typename Handler, typename DefaultCandidate>
+struct associator<Associator,
+                   asioex::detail::immediate_handler<Handler>, DefaultCandidate>
+: Associator<Handler, DefaultCandidate>
+{
+    static typename Associator<Handler, DefaultCandidate>::type get(
+        const asioex::detail::immediate_handler<Handler>& h,
+        const DefaultCandidate& c = DefaultCandidate()) ASIO_NOEXCEPT
+    {
+        return Associator<Handler, DefaultCandidate>::get(
+            asioex::detail::adapter_access::handler(h), c);
+    }
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#endif   // ASIOEX_IMMEDIATE_HPP
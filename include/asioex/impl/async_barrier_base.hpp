@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_ASYNC_BARRIER_BASE_HPP
+#define ASIOEX_IMPL_ASYNC_BARRIER_BASE_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
+#include <asioex/async_barrier.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+
+namespace asioex
+{
+async_barrier_base::async_barrier_base(std::ptrdiff_t expected)
+: waiters_()
+, expected_(expected)
+, pending_(expected)
+, phase_(0)
+, pool_stats_()
+{
+    ASIO_ASSERT(expected > 0);
+}
+
+async_barrier_base::~async_barrier_base()
+{
+    detail::complete_all< async_barrier_base >(waiters_,
+                                               asio::error::operation_aborted);
+}
+
+std::ptrdiff_t
+async_barrier_base::expected() const noexcept
+{
+    return expected_;
+}
+
+std::ptrdiff_t
+async_barrier_base::pending() const noexcept
+{
+    return pending_;
+}
+
+std::uint64_t
+async_barrier_base::phase() const noexcept
+{
+    return phase_;
+}
+
+wait_op_pool_stats
+async_barrier_base::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+bool
+async_barrier_base::count_arrival(std::ptrdiff_t n)
+{
+    ASIO_ASSERT(n > 0 && n <= pending_);
+    pending_ -= n;
+    return pending_ == 0;
+}
+
+void
+async_barrier_base::drop()
+{
+    ASIO_ASSERT(expected_ > 0);
+    --expected_;
+}
+
+void
+async_barrier_base::finish_phase()
+{
+    ++phase_;
+    pending_ = expected_;
+    detail::complete_all< async_barrier_base >(waiters_, error_code());
+}
+
+void
+async_barrier_base::add_waiter(wait_op *waiter)
+{
+    waiters_.push_back(waiter);
+}
+
+void
+async_barrier_base::cancel_waiter(wait_op *waiter)
+{
+    // the arrival is not withdrawn, others may already depend on it
+    waiters_.erase(waiter);
+    waiter->complete(asio::error::operation_aborted);
+}
+
+void
+async_barrier_base::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+}   // namespace asioex
+
+#endif
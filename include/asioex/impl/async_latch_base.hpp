@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_ASYNC_LATCH_BASE_HPP
+#define ASIOEX_IMPL_ASYNC_LATCH_BASE_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
+#include <asioex/async_latch.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+
+namespace asioex
+{
+async_latch_base::async_latch_base(std::ptrdiff_t expected)
+: waiters_()
+, count_(expected)
+, pool_stats_()
+{
+    ASIO_ASSERT(expected >= 0);
+}
+
+async_latch_base::~async_latch_base()
+{
+    detail::complete_all< async_latch_base >(waiters_,
+                                             asio::error::operation_aborted);
+}
+
+void
+async_latch_base::count_down(std::ptrdiff_t n)
+{
+    ASIO_ASSERT(n >= 0 && n <= count_);
+    count_ -= n;
+    if (count_ == 0)
+        detail::complete_all< async_latch_base >(waiters_, error_code());
+}
+
+bool
+async_latch_base::try_wait() const noexcept
+{
+    return count_ == 0;
+}
+
+std::ptrdiff_t
+async_latch_base::value() const noexcept
+{
+    return count_;
+}
+
+wait_op_pool_stats
+async_latch_base::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+void
+async_latch_base::add_waiter(wait_op *waiter)
+{
+    waiters_.push_back(waiter);
+}
+
+void
+async_latch_base::cancel_waiter(wait_op *waiter)
+{
+    waiters_.erase(waiter);
+    waiter->complete(asio::error::operation_aborted);
+}
+
+void
+async_latch_base::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_ASYNC_QUEUE_BASE_HPP
+#define ASIOEX_IMPL_ASYNC_QUEUE_BASE_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
+#include <asioex/async_queue.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+
+#include <algorithm>
+
+namespace asioex
+{
+template < class T, class Weight >
+async_queue_base< T, Weight >::async_queue_base(std::size_t capacity,
+                                                Weight      weight)
+: items_()
+, capacity_(capacity)
+, used_(0)
+, closed_(false)
+, pushers_()
+, poppers_()
+, pool_stats_()
+, weight_(std::move(weight))
+{
+    ASIO_ASSERT(capacity > 0);
+}
+
+template < class T, class Weight >
+async_queue_base< T, Weight >::~async_queue_base()
+{
+    detail::sized_bilist aborted;
+    aborted.splice_back(pushers_);
+    aborted.splice_back(poppers_);
+    detail::complete_all< async_queue_base >(aborted,
+                                             asio::error::operation_aborted);
+}
+
+template < class T, class Weight >
+bool
+async_queue_base< T, Weight >::try_push(T &&value)
+{
+    if (closed_ || !pushers_.empty() || !admit(value))
+        return false;
+    notify();
+    return true;
+}
+
+template < class T, class Weight >
+bool
+async_queue_base< T, Weight >::try_pop(T &value)
+{
+    if (items_.empty())
+        return false;
+    value = take();
+    notify();
+    return true;
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::try_pop_some(std::span< T > out)
+{
+    auto n = take_some(out);
+    if (n)
+        notify();
+    return n;
+}
+
+template < class T, class Weight >
+void
+async_queue_base< T, Weight >::close()
+{
+    if (std::exchange(closed_, true))
+        return;
+
+    // waiting poppers imply an empty queue
+    detail::complete_all< async_queue_base >(pushers_,
+                                             asio::error::broken_pipe);
+    detail::complete_all< async_queue_base >(poppers_, asio::error::eof);
+}
+
+template < class T, class Weight >
+bool
+async_queue_base< T, Weight >::is_open() const noexcept
+{
+    return !closed_;
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::size() const noexcept
+{
+    return items_.size();
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::used() const noexcept
+{
+    return used_;
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::capacity() const noexcept
+{
+    return capacity_;
+}
+
+template < class T, class Weight >
+wait_op_pool_stats
+async_queue_base< T, Weight >::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+template < class T, class Weight >
+void
+async_queue_base< T, Weight >::add_waiter(wait_op *waiter)
+{
+    if (waiter->requested_ == push_waiter)
+        pushers_.push_back(waiter);
+    else
+        poppers_.push_back(waiter);
+}
+
+template < class T, class Weight >
+bool
+async_queue_base< T, Weight >::admit(T &value)
+{
+    auto w = weigh(value);
+    if (w > capacity_ - used_)
+        return false;
+    items_.push(std::move(value));
+    used_ += w;
+    return true;
+}
+
+template < class T, class Weight >
+T
+async_queue_base< T, Weight >::take()
+{
+    used_ -= weigh(items_.front());
+    return items_.pop();
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::take_some(std::span< T > out)
+{
+    auto n = std::min(out.size(), items_.size());
+    for (std::size_t i = 0; i < n;)
+    {
+        auto run = items_.front_span();
+        run      = run.first(std::min(run.size(), n - i));
+        for (auto &item : run)
+        {
+            used_ -= weigh(item);
+            out[i++] = std::move(item);
+        }
+        items_.consume(run.size());
+    }
+    return n;
+}
+
+template < class T, class Weight >
+void
+async_queue_base< T, Weight >::notify()
+{
+    // taking an item may make room for a pusher, and admitting a pusher's
+    // item may feed a popper, so keep going until neither can progress
+    detail::sized_bilist ready;
+    try
+    {
+        for (;;)
+        {
+            if (!poppers_.empty() && !items_.empty())
+            {
+                auto op = static_cast< wait_op * >(poppers_.front());
+                op->ready();
+                ready.push_back(poppers_.pop_front());
+                continue;
+            }
+            if (!pushers_.empty() &&
+                static_cast< wait_op * >(pushers_.front())->ready())
+            {
+                ready.push_back(pushers_.pop_front());
+                continue;
+            }
+            break;
+        }
+    }
+    catch (...)
+    {
+        detail::complete_all< async_queue_base >(ready, error_code());
+        throw;
+    }
+    detail::complete_all< async_queue_base >(ready, error_code());
+}
+
+template < class T, class Weight >
+void
+async_queue_base< T, Weight >::cancel_waiter(wait_op *waiter)
+{
+    auto was_front =
+        waiter->requested_ == push_waiter && pushers_.front() == waiter;
+    if (waiter->requested_ == push_waiter)
+        pushers_.erase(waiter);
+    else
+        poppers_.erase(waiter);
+    waiter->complete(asio::error::operation_aborted);
+
+    // a cancelled heavy push at the head may have been holding back
+    // lighter ones behind it
+    if (was_front)
+        notify();
+}
+
+template < class T, class Weight >
+void
+async_queue_base< T, Weight >::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+template < class T, class Weight >
+std::size_t
+async_queue_base< T, Weight >::weigh(T const &value) const
+{
+    return std::min(weight_(value), capacity_);
+}
+
+}   // namespace asioex
+
+#endif
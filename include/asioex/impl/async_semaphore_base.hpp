@@ -12,6 +12,7 @@
 
 #include <asio/detail/assert.hpp>
 #include <asio/error.hpp>
+#include <asioex/detail/semaphore_deadline_timer.hpp>
 #include <asioex/async_semaphore.hpp>
 #include <asioex/detail/semaphore_wait_op.hpp>
 
@@ -20,20 +21,152 @@ namespace asioex
 async_semaphore_base::async_semaphore_base(int initial_count)
 : waiters_()
 , count_(initial_count)
+, demand_(0)
+, pool_stats_()
+, deadlines_()
+, deadline_timer_()
+, inbox_(0)
 {
 }
 
 async_semaphore_base::~async_semaphore_base()
 {
-    auto & nx = waiters_.next_;
-    while (nx != &waiters_)
-         static_cast< detail::semaphore_wait_op * >(nx)->complete(asio::error::operation_aborted);
+    // the timer may have a completion in flight which must not reach us
+    if (deadline_timer_)
+    {
+        deadline_timer_->host_ = nullptr;
+        deadline_timer_->disarm();
+    }
+    detail::complete_all< async_semaphore_base >(
+        waiters_, asio::error::operation_aborted);
 }
 
+template < class QueuePolicy >
 void
 async_semaphore_base::add_waiter(detail::semaphore_wait_op *waiter)
 {
-    waiter->link_before(&waiters_);
+    QueuePolicy::enqueue(waiters_, waiter);
+    demand_ += waiter->requested_;
+}
+
+template < class Executor >
+void
+async_semaphore_base::add_deadline(detail::semaphore_wait_op *waiter,
+                                   clock_type::time_point     when,
+                                   Executor const            &exec)
+{
+    try
+    {
+        if (!deadline_timer_)
+            deadline_timer_ = std::make_shared<
+                detail::semaphore_deadline_timer_impl< async_semaphore_base,
+                                                       Executor > >(this,
+                                                                    exec);
+
+        // deadlines mostly arrive in order, so scan from the latest
+        waiter->deadline_.when_ = when;
+        detail::bilist_node *pos = &deadlines_;
+        while (pos->prev_ != &deadlines_ &&
+               static_cast< deadline_link * >(pos->prev_)->when_ > when)
+            pos = pos->prev_;
+        waiter->deadline_.link_before(pos);
+
+        deadline_timer_->arm(when);
+    }
+    catch (...)
+    {
+        forget_deadline(waiter);
+        waiters_.erase(waiter);
+        demand_ -= waiter->requested_;
+        throw;
+    }
+}
+
+void
+async_semaphore_base::forget_deadline(detail::semaphore_wait_op *waiter)
+{
+    waiter->deadline_.unlink();
+    if (deadline_timer_ && deadlines_.next_ == &deadlines_)
+        deadline_timer_->disarm();
+}
+
+void
+async_semaphore_base::expire_waiters(clock_type::time_point now)
+{
+    detail::sized_bilist expired;
+    bool                 was_front = false;
+    while (deadlines_.next_ != &deadlines_)
+    {
+        auto link = static_cast< deadline_link * >(deadlines_.next_);
+        if (link->when_ > now)
+        {
+            deadline_timer_->arm(link->when_);
+            break;
+        }
+        auto op = link->op_;
+        link->unlink();
+        was_front = was_front || waiters_.front() == op;
+        waiters_.erase(op);
+        demand_ -= op->requested_;
+        expired.push_back(op);
+    }
+    detail::complete_all< async_semaphore_base >(expired,
+                                                 asio::error::timed_out);
+
+    // an expired request at the head may have been holding back others
+    if (was_front)
+        release(0);
+}
+
+void
+async_semaphore_base::cancel_waiter(detail::semaphore_wait_op *waiter)
+{
+    auto was_front = waiters_.front() == waiter;
+    waiters_.erase(waiter);
+    forget_deadline(waiter);
+    demand_ -= waiter->requested_;
+    waiter->complete(asio::error::operation_aborted);
+
+    // a cancelled large request at the head may have been holding back
+    // smaller requests which can now be satisfied
+    if (was_front)
+        release(0);
+}
+
+void
+async_semaphore_base::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+wait_op_pool_stats
+async_semaphore_base::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+std::size_t
+async_semaphore_base::waiters() const noexcept
+{
+    return waiters_.size();
+}
+
+bool
+async_semaphore_base::push_inbox(int n) noexcept
+{
+    // release ordering publishes whatever the releasing thread did before
+    // releasing to the waiter which is resumed by the drain
+    return inbox_.fetch_add(n, std::memory_order_acq_rel) == 0;
+}
+
+void
+async_semaphore_base::drain_inbox()
+{
+    // everything pushed after this exchange will post a drain of its own
+    release(inbox_.exchange(0, std::memory_order_acq_rel));
 }
 
 int
@@ -43,28 +176,42 @@ async_semaphore_base::count() const noexcept
 }
 
 void
-async_semaphore_base::release()
+async_semaphore_base::release(int n)
 {
-    count_ += 1;
+    count_ += n;
 
-    // release a pending operations
-    if (waiters_.next_ == &waiters_)
-        return;
-
-    decrement();
-    static_cast< detail::semaphore_wait_op * >(waiters_.next_)
-        ->complete(std::error_code());
+    // complete pending operations in order for as long as the head of the
+    // queue can be satisfied
+    detail::sized_bilist ready;
+    while (!waiters_.empty())
+    {
+        auto op =
+            static_cast< detail::semaphore_wait_op * >(waiters_.front());
+        if (op->requested_ > count_)
+            break;
+        decrement(op->requested_);
+        demand_ -= op->requested_;
+        ready.push_back(waiters_.pop_front());
+        forget_deadline(op);
+    }
+    detail::complete_all< async_semaphore_base >(ready, error_code());
 }
 
 std::size_t async_semaphore_base::release_all()
 {
-    std::size_t sz = 0u;
-    auto & nx = waiters_.next_;
-    while (nx != &waiters_)
-    {
-        static_cast< detail::semaphore_wait_op * >(nx)->complete(asio::error_code());
-        sz ++ ;
-    }
+    if (waiters_.empty())
+        return 0u;
+
+    // every waiter is satisfied, which leaves the count at zero
+    auto sz = static_cast< std::size_t >(demand_ - count_);
+    count_  = 0;
+    demand_ = 0;
+
+    detail::sized_bilist ready;
+    ready.splice_back(waiters_);
+    for (auto n = ready.front(); n != ready.end(); n = n->next_)
+        forget_deadline(static_cast< detail::semaphore_wait_op * >(n));
+    detail::complete_all< async_semaphore_base >(ready, error_code());
     return sz;
 }
 
@@ -72,29 +219,26 @@ std::size_t async_semaphore_base::release_all()
 ASIO_NODISCARD inline int
 async_semaphore_base::value() const noexcept
 {
-    if (waiters_.next_ == &waiters_)
-        return count();
-
-    return count() - static_cast<int>(waiters_.size());
+    return count() - demand_;
 }
 
 bool
-async_semaphore_base::try_acquire()
+async_semaphore_base::try_acquire(int n)
 {
     bool acquired = false;
-    if (count_ > 0)
+    if (waiters_.empty() && count_ >= n)
     {
-        --count_;
+        decrement(n);
         acquired = true;
     }
     return acquired;
 }
 
 int
-async_semaphore_base::decrement()
+async_semaphore_base::decrement(int n)
 {
-    ASIO_ASSERT(count_ > 0);
-    return --count_;
+    ASIO_ASSERT(count_ >= n);
+    return count_ -= n;
 }
 
 }   // namespace asioex
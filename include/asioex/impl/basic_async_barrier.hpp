@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_BASIC_ASYNC_BARRIER_HPP
+#define ASIOEX_IMPL_BASIC_ASYNC_BARRIER_HPP
+
+#include <asioex/async_barrier.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
+
+namespace asioex
+{
+template < class Executor, class CompletionFunction >
+basic_async_barrier< Executor, CompletionFunction >::basic_async_barrier(
+    executor_type      exec,
+    std::ptrdiff_t     expected,
+    CompletionFunction completion)
+: async_barrier_base(expected)
+, exec_(std::move(exec))
+, completion_(std::move(completion))
+{
+}
+
+template < class Executor, class CompletionFunction >
+typename basic_async_barrier< Executor, CompletionFunction >::executor_type const &
+basic_async_barrier< Executor, CompletionFunction >::get_executor() const
+{
+    return exec_;
+}
+
+template < class Executor, class CompletionFunction >
+void
+basic_async_barrier< Executor, CompletionFunction >::arrive(std::ptrdiff_t n)
+{
+    if (count_arrival(n))
+        complete_phase();
+}
+
+template < class Executor, class CompletionFunction >
+void
+basic_async_barrier< Executor, CompletionFunction >::arrive_and_drop()
+{
+    drop();
+    arrive(1);
+}
+
+template < class Executor, class CompletionFunction >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_async_barrier< Executor, CompletionFunction >::async_arrive_and_wait(
+    CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code) >(
+        [this]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            if (count_arrival(1))
+            {
+                complete_phase();
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+
+            using handler_type = std::decay_t< Handler >;
+            using model_type =
+                detail::semaphore_wait_op_model< decltype(e),
+                                                 handler_type,
+                                                 async_barrier_base >;
+            add_waiter(model_type::construct(
+                this, 0, std::move(e), std::forward< Handler >(handler)));
+        },
+        token);
+}
+
+template < class Executor, class CompletionFunction >
+void
+basic_async_barrier< Executor, CompletionFunction >::complete_phase()
+{
+    completion_();
+    finish_phase();
+}
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_BASIC_ASYNC_LATCH_HPP
+#define ASIOEX_IMPL_BASIC_ASYNC_LATCH_HPP
+
+#include <asioex/async_latch.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
+
+namespace asioex
+{
+template < class Executor >
+basic_async_latch< Executor >::basic_async_latch(executor_type  exec,
+                                                 std::ptrdiff_t expected)
+: async_latch_base(expected)
+, exec_(std::move(exec))
+{
+}
+
+template < class Executor >
+typename basic_async_latch< Executor >::executor_type const &
+basic_async_latch< Executor >::get_executor() const
+{
+    return exec_;
+}
+
+template < class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_async_latch< Executor >::async_wait(CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code) >(
+        [this]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            if (try_wait())
+            {
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+
+            using handler_type = std::decay_t< Handler >;
+            using model_type =
+                detail::semaphore_wait_op_model< decltype(e),
+                                                 handler_type,
+                                                 async_latch_base >;
+            add_waiter(model_type::construct(
+                this, 0, std::move(e), std::forward< Handler >(handler)));
+        },
+        token);
+}
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_BASIC_ASYNC_QUEUE_HPP
+#define ASIOEX_IMPL_BASIC_ASYNC_QUEUE_HPP
+
+#include <asio/error.hpp>
+#include <asioex/async_queue.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
+
+namespace asioex
+{
+template < class T, class Executor, class Weight >
+basic_async_queue< T, Executor, Weight >::basic_async_queue(
+    executor_type exec,
+    std::size_t   capacity,
+    Weight        weight)
+: base_type(capacity, std::move(weight))
+, exec_(std::move(exec))
+{
+}
+
+template < class T, class Executor, class Weight >
+typename basic_async_queue< T, Executor, Weight >::executor_type const &
+basic_async_queue< T, Executor, Weight >::get_executor() const
+{
+    return exec_;
+}
+
+template < class T, class Executor, class Weight >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_async_queue< T, Executor, Weight >::async_push(T value,
+                                                     CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code) >(
+        [this]< class Handler >(Handler &&handler, T value)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            if (!this->is_open())
+            {
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(asio::error::broken_pipe));
+                return;
+            }
+            if (this->try_push(std::move(value)))
+            {
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+
+            park(base_type::push_waiter,
+                 typename base_type::push_action { this, std::move(value) },
+                 std::move(e),
+                 std::forward< Handler >(handler));
+        },
+        token,
+        std::move(value));
+}
+
+template < class T, class Executor, class Weight >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, T)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, T))
+basic_async_queue< T, Executor, Weight >::async_pop(CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code, T) >(
+        [this]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            if (this->size())
+            {
+                T value = this->take();
+                this->notify();
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(),
+                                     std::move(value));
+                return;
+            }
+            if (!this->is_open())
+            {
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(asio::error::eof),
+                                     T());
+                return;
+            }
+
+            park(base_type::pop_waiter,
+                 typename base_type::pop_action { this },
+                 std::move(e),
+                 std::forward< Handler >(handler));
+        },
+        token);
+}
+
+template < class T, class Executor, class Weight >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, std::size_t))
+               CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, std::size_t))
+basic_async_queue< T, Executor, Weight >::async_pop_some(
+    std::span< T >    out,
+    CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken,
+                                 void(std::error_code, std::size_t) >(
+        [this, out]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            if (out.empty())
+            {
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(),
+                                     std::size_t(0));
+                return;
+            }
+            if (auto n = this->try_pop_some(out))
+            {
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code(), n);
+                return;
+            }
+            if (!this->is_open())
+            {
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(asio::error::eof),
+                                     std::size_t(0));
+                return;
+            }
+
+            park(base_type::pop_waiter,
+                 typename base_type::pop_some_action { this, out },
+                 std::move(e),
+                 std::forward< Handler >(handler));
+        },
+        token);
+}
+
+template < class T, class Executor, class Weight >
+template < class Action, class AssociatedExecutor, class Handler >
+void
+basic_async_queue< T, Executor, Weight >::park(
+    typename base_type::waiter_kind kind,
+    Action                        &&action,
+    AssociatedExecutor              e,
+    Handler                       &&handler)
+{
+    using handler_type = detail::queue_wait_handler< std::decay_t< Action >,
+                                                     std::decay_t< Handler > >;
+    using model_type   = detail::
+        semaphore_wait_op_model< AssociatedExecutor, handler_type, base_type >;
+    this->add_waiter(
+        model_type::construct(this,
+                              kind,
+                              std::move(e),
+                              handler_type(std::forward< Action >(action),
+                                           std::forward< Handler >(handler))));
+}
+
+}   // namespace asioex
+
+#endif
@@ -10,54 +10,163 @@
 #ifndef ASIOEX_IMPL_BASIC_ASYNC_SEMAPHORE_HPP
 #define ASIOEX_IMPL_BASIC_ASYNC_SEMAPHORE_HPP
 
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
 #include <asio/error_code.hpp>
 #include <asio/post.hpp>
 #include <asioex/async_semaphore.hpp>
 #include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
 
 namespace asioex
 {
-template < class Executor >
-basic_async_semaphore< Executor >::basic_async_semaphore(executor_type exec,
-                                                         int initial_count)
+template < class Executor, class QueuePolicy, class StatsPolicy >
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::
+    basic_async_semaphore(executor_type exec, int initial_count)
 : async_semaphore_base(initial_count)
 , exec_(std::move(exec))
 {
 }
 
-template < class Executor >
-typename basic_async_semaphore< Executor >::executor_type const &
-basic_async_semaphore< Executor >::get_executor() const
+template < class Executor, class QueuePolicy, class StatsPolicy >
+typename basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::
+    executor_type const &
+    basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::get_executor()
+        const
 {
     return exec_;
 }
 
-template < class Executor >
+template < class Executor, class QueuePolicy, class StatsPolicy >
+void
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::
+    release_from_any_thread(int n)
+{
+    ASIO_ASSERT(n >= 0);
+    if (push_inbox(n))
+        asio::post(exec_, [this] { drain_inbox(); });
+}
+
+template < class Executor, class QueuePolicy, class StatsPolicy >
+sync_stats_snapshot
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::stats()
+    const noexcept
+{
+    return stats_.snapshot();
+}
+
+template < class Executor, class QueuePolicy, class StatsPolicy >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler >
+ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::async_acquire(
+    CompletionHandler &&token)
+{
+    return async_acquire(1, std::forward< CompletionHandler >(token));
+}
+
+template < class Executor, class QueuePolicy, class StatsPolicy >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler >
+ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::async_acquire(
+    int                 n,
+    CompletionHandler &&token)
+{
+    ASIO_ASSERT(n >= 0);
+    return asio::async_initiate< CompletionHandler, void(std::error_code) >(
+        [this, n]< class Handler >(Handler &&handler)
+        {
+            stats_.on_acquire();
+            auto e = get_associated_executor(handler, get_executor());
+            if (try_acquire(n))
+            {
+                stats_.on_fast_path();
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+
+            auto priority = get_associated_wait_priority(handler);
+            auto &&parked =
+                stats_.on_park(waiters() + 1, std::forward< Handler >(handler));
+            using handler_type = std::decay_t< decltype(parked) >;
+            using model_type =
+                detail::semaphore_wait_op_model< decltype(e), handler_type >;
+            model_type *model = model_type ::construct(
+                this,
+                n,
+                std::move(e),
+                std::forward< decltype(parked) >(parked));
+            model->priority_ = priority;
+            try
+            {
+                add_waiter< QueuePolicy >(model);
+            }
+            catch (...)
+            {
+                model_type::destroy(model);
+                throw;
+            }
+        },
+        token);
+}
+
+template < class Executor, class QueuePolicy, class StatsPolicy >
 template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler >
 ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
-basic_async_semaphore< Executor >::async_acquire(CompletionHandler &&token)
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::async_acquire_until(
+    std::chrono::steady_clock::time_point deadline,
+    CompletionHandler                   &&token)
 {
+    return async_acquire_until(
+        1, deadline, std::forward< CompletionHandler >(token));
+}
+
+template < class Executor, class QueuePolicy, class StatsPolicy >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler >
+ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >::async_acquire_until(
+    int                                   n,
+    std::chrono::steady_clock::time_point deadline,
+    CompletionHandler                   &&token)
+{
+    ASIO_ASSERT(n >= 0);
     return asio::async_initiate< CompletionHandler, void(std::error_code) >(
-        [this]< class Handler >(Handler &&handler)
+        [this, n, deadline]< class Handler >(Handler &&handler)
         {
+            stats_.on_acquire();
             auto e = get_associated_executor(handler, get_executor());
-            if (count())
+            if (try_acquire(n))
+            {
+                stats_.on_fast_path();
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+            if (deadline <= clock_type::now())
             {
-                decrement();
-                asio::post(std::move(e),
-                           asio::experimental::append(
-                               std::forward< Handler >(handler), error_code()));
+                stats_.on_timeout();
+                detail::complete_now(e,
+                                     std::forward< Handler >(handler),
+                                     error_code(asio::error::timed_out));
                 return;
             }
 
-            using handler_type = std::decay_t< Handler >;
+            auto priority = get_associated_wait_priority(handler);
+            auto &&parked =
+                stats_.on_park(waiters() + 1, std::forward< Handler >(handler));
+            using handler_type = std::decay_t< decltype(parked) >;
             using model_type =
                 detail::semaphore_wait_op_model< decltype(e), handler_type >;
             model_type *model = model_type ::construct(
-                this, std::move(e), std::forward< Handler >(handler));
+                this,
+                n,
+                std::move(e),
+                std::forward< decltype(parked) >(parked));
+            model->priority_ = priority;
             try
             {
-                add_waiter(model);
+                add_waiter< QueuePolicy >(model);
+                add_deadline(model, deadline, get_executor());
             }
             catch (...)
             {
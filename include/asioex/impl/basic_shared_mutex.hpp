@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_BASIC_SHARED_MUTEX_HPP
+#define ASIOEX_IMPL_BASIC_SHARED_MUTEX_HPP
+
+#include <asio/compose.hpp>
+#include <asio/detail/assert.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
+#include <asioex/shared_mutex.hpp>
+
+namespace asioex
+{
+template < class Executor >
+basic_shared_mutex< Executor >::basic_shared_mutex(executor_type exec)
+: shared_mutex_base()
+, exec_(std::move(exec))
+{
+}
+
+template < class Executor >
+typename basic_shared_mutex< Executor >::executor_type const &
+basic_shared_mutex< Executor >::get_executor() const
+{
+    return exec_;
+}
+
+template < class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_shared_mutex< Executor >::async_lock(CompletionToken &&token)
+{
+    return async_wait_for(exclusive_lock,
+                          std::forward< CompletionToken >(token));
+}
+
+template < class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_shared_mutex< Executor >::async_lock_shared(CompletionToken &&token)
+{
+    return async_wait_for(shared_lock, std::forward< CompletionToken >(token));
+}
+
+template < class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_shared_mutex< Executor >::async_lock_upgrade(CompletionToken &&token)
+{
+    return async_wait_for(upgrade_lock, std::forward< CompletionToken >(token));
+}
+
+template < class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_shared_mutex< Executor >::async_upgrade(CompletionToken &&token)
+{
+    return async_wait_for(upgrading_lock,
+                          std::forward< CompletionToken >(token));
+}
+
+template < class Executor >
+template < class CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+basic_shared_mutex< Executor >::async_wait_for(lock_kind         kind,
+                                               CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code) >(
+        [this, kind]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+
+            if (try_acquire(kind))
+            {
+                detail::complete_now(
+                    e, std::forward< Handler >(handler), error_code());
+                return;
+            }
+
+            using handler_type = std::decay_t< Handler >;
+            using model_type =
+                detail::semaphore_wait_op_model< decltype(e),
+                                                 handler_type,
+                                                 shared_mutex_base >;
+            model_type *model = model_type ::construct(
+                this, kind, std::move(e), std::forward< Handler >(handler));
+            add_waiter(model);
+        },
+        token);
+}
+
+template < typename Executor,
+           ASIO_COMPLETION_TOKEN_FOR(
+               void(error_code, basic_shared_lock_guard< Executor >))
+               CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+                        void(error_code, basic_shared_lock_guard< Executor >))
+async_shared_guard(basic_shared_mutex< Executor > &mtx,
+                   CompletionToken                &&token)
+{
+    return asio::async_compose< CompletionToken,
+                                void(error_code,
+                                     basic_shared_lock_guard< Executor >) >(
+        [&](auto &self)
+        {
+            mtx.async_lock_shared(
+                [&, s = std::move(self)](error_code ec) mutable
+                {
+                    // a failed wait owns nothing, so its guard is empty
+                    std::move(s).complete(
+                        ec,
+                        basic_shared_lock_guard< Executor >(ec ? nullptr
+                                                               : &mtx));
+                });
+        },
+        token,
+        mtx);
+}
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_IMPL_SHARED_MUTEX_BASE_HPP
+#define ASIOEX_IMPL_SHARED_MUTEX_BASE_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+#include <asioex/shared_mutex.hpp>
+
+namespace asioex
+{
+shared_mutex_base::shared_mutex_base()
+: shared_(0)
+, exclusive_(false)
+, upgrade_(false)
+, upgrading_(nullptr)
+, shared_waiters_()
+, exclusive_waiters_()
+, upgrade_waiters_()
+, pool_stats_()
+{
+}
+
+shared_mutex_base::~shared_mutex_base()
+{
+    detail::sized_bilist aborted;
+    if (upgrading_)
+        aborted.push_back(std::exchange(upgrading_, nullptr));
+    aborted.splice_back(exclusive_waiters_);
+    aborted.splice_back(upgrade_waiters_);
+    aborted.splice_back(shared_waiters_);
+    detail::complete_all< shared_mutex_base >(aborted,
+                                              asio::error::operation_aborted);
+}
+
+bool
+shared_mutex_base::try_grant(lock_kind kind)
+{
+    if (exclusive_)
+        return false;
+
+    switch (kind)
+    {
+    case shared_lock:
+        // writer preference: queued writers hold back new readers
+        if (upgrading_ || !exclusive_waiters_.empty())
+            return false;
+        ++shared_;
+        return true;
+
+    case exclusive_lock:
+        if (shared_ || upgrade_)
+            return false;
+        exclusive_ = true;
+        return true;
+
+    case upgrade_lock:
+        if (upgrade_ || !exclusive_waiters_.empty())
+            return false;
+        upgrade_ = true;
+        return true;
+
+    case upgrading_lock:
+        ASIO_ASSERT(upgrade_);
+        if (shared_)
+            return false;
+        upgrade_   = false;
+        exclusive_ = true;
+        return true;
+    }
+    return false;
+}
+
+bool
+shared_mutex_base::try_acquire(lock_kind kind)
+{
+    // there is never more than one upgrade pending, so only the other kinds
+    // can have a queue to respect
+    switch (kind)
+    {
+    case shared_lock:
+        if (!shared_waiters_.empty())
+            return false;
+        break;
+    case exclusive_lock:
+        if (!exclusive_waiters_.empty())
+            return false;
+        break;
+    case upgrade_lock:
+        if (!upgrade_waiters_.empty())
+            return false;
+        break;
+    case upgrading_lock:
+        break;
+    }
+    return try_grant(kind);
+}
+
+bool
+shared_mutex_base::try_lock()
+{
+    return try_acquire(exclusive_lock);
+}
+
+bool
+shared_mutex_base::try_lock_shared()
+{
+    return try_acquire(shared_lock);
+}
+
+bool
+shared_mutex_base::try_lock_upgrade()
+{
+    return try_acquire(upgrade_lock);
+}
+
+void
+shared_mutex_base::unlock()
+{
+    ASIO_ASSERT(exclusive_);
+    exclusive_ = false;
+    notify();
+}
+
+void
+shared_mutex_base::unlock_shared()
+{
+    ASIO_ASSERT(shared_ > 0);
+    --shared_;
+    notify();
+}
+
+void
+shared_mutex_base::unlock_upgrade()
+{
+    ASIO_ASSERT(upgrade_);
+    upgrade_ = false;
+    notify();
+}
+
+void
+shared_mutex_base::unlock_and_lock_shared()
+{
+    ASIO_ASSERT(exclusive_);
+    exclusive_ = false;
+    ++shared_;
+    notify();
+}
+
+std::size_t
+shared_mutex_base::shared_count() const noexcept
+{
+    return shared_;
+}
+
+wait_op_pool_stats
+shared_mutex_base::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+void
+shared_mutex_base::add_waiter(wait_op *waiter)
+{
+    switch (waiter->requested_)
+    {
+    case shared_lock:
+        shared_waiters_.push_back(waiter);
+        break;
+    case exclusive_lock:
+        exclusive_waiters_.push_back(waiter);
+        break;
+    case upgrade_lock:
+        upgrade_waiters_.push_back(waiter);
+        break;
+    case upgrading_lock:
+        ASIO_ASSERT(!upgrading_);
+        upgrading_ = waiter;
+        break;
+    }
+}
+
+void
+shared_mutex_base::cancel_waiter(wait_op *waiter)
+{
+    switch (waiter->requested_)
+    {
+    case shared_lock:
+        shared_waiters_.erase(waiter);
+        break;
+    case exclusive_lock:
+        exclusive_waiters_.erase(waiter);
+        break;
+    case upgrade_lock:
+        upgrade_waiters_.erase(waiter);
+        break;
+    case upgrading_lock:
+        upgrading_ = nullptr;
+        break;
+    }
+    waiter->complete(asio::error::operation_aborted);
+
+    // a cancelled writer may have been holding back readers
+    notify();
+}
+
+void
+shared_mutex_base::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+void
+shared_mutex_base::notify()
+{
+    detail::sized_bilist ready;
+
+    if (upgrading_)
+    {
+        // a pending upgrade outranks everything, it only waits for readers
+        if (try_grant(upgrading_lock))
+            ready.push_back(std::exchange(upgrading_, nullptr));
+    }
+    else if (!exclusive_waiters_.empty())
+    {
+        if (try_grant(exclusive_lock))
+            ready.push_back(exclusive_waiters_.pop_front());
+    }
+    else if (!exclusive_)
+    {
+        if (!upgrade_waiters_.empty() && try_grant(upgrade_lock))
+            ready.push_back(upgrade_waiters_.pop_front());
+
+        // no writer is queued, so every reader may enter at once
+        shared_ += shared_waiters_.size();
+        ready.splice_back(shared_waiters_);
+    }
+
+    detail::complete_all< shared_mutex_base >(ready, error_code());
+}
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_MT_ASYNC_SEMAPHORE_HPP
+#define ASIOEX_MT_ASYNC_SEMAPHORE_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace asioex
+{
+namespace mt
+{
+struct async_semaphore_base;
+}
+
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+}   // namespace detail
+
+namespace mt
+{
+/// @brief The executor-independent part of a thread-safe async semaphore.
+/// @details The count is held in an atomic so that try_acquire and an
+/// uncontended release are a single atomic operation. Only when an acquire
+/// has to park, or a release finds parked waiters, is the wait list mutex
+/// taken.
+struct async_semaphore_base
+{
+    inline async_semaphore_base(int initial_count);
+
+    async_semaphore_base(async_semaphore_base const &) ASIO_DELETED;
+
+    async_semaphore_base &
+    operator=(async_semaphore_base const &) ASIO_DELETED;
+
+    async_semaphore_base(async_semaphore_base &&) ASIO_DELETED;
+
+    async_semaphore_base &
+    operator=(async_semaphore_base &&) ASIO_DELETED;
+
+    inline ~async_semaphore_base();
+
+    /// @brief Attempt to immediately acquire the semaphore.
+    /// @details This function may be called from any thread.
+    /// @param n is the number of units to acquire.
+    /// @returns true if the semaphore was acquired, false otherwise
+    inline bool
+    try_acquire(int n = 1);
+
+    /// @brief Release the sempahore.
+    /// @details This function may be called from any thread. Pending
+    /// async_acquire operations are completed in FIFO order for as long as the
+    /// count satisfies the least recent one.
+    /// @param n is the number of units to release.
+    inline void
+    release(int n = 1);
+
+    /// @brief Release the sempahore to achieve a value of zero.
+    /// @returns The number of units released.
+    /// @details As asioex::async_semaphore_base::release_all.
+    inline std::size_t
+    release_all();
+
+    ASIO_NODISCARD inline int
+    value() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< async_semaphore_base >;
+
+    inline void
+    add_waiter(wait_op *waiter);
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    notify_waiters();
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    std::atomic< int >         count_;
+    std::atomic< int >         waiting_;
+    std::mutex                 mutex_;
+    detail::sized_bilist       waiters_;
+    std::atomic< std::size_t > pool_hits_;
+    std::atomic< std::size_t > pool_misses_;
+};
+
+/// @brief An async semaphore which may be shared between threads.
+/// @details This type has the same interface as asioex::basic_async_semaphore
+/// but all member functions may be invoked concurrently. Waiters are released
+/// in FIFO order, but an acquire which finds a free count takes it without
+/// queueing, so strict FIFO fairness is not guaranteed. In particular a large
+/// weighted request may be overtaken by a stream of smaller ones.
+template < class Executor = asio::any_io_executor >
+struct basic_async_semaphore : async_semaphore_base
+{
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// Rebinds the semaphore type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The semaphore type when rebound to the specified executor.
+        typedef basic_async_semaphore< Executor1 > other;
+    };
+
+    /// @brief Construct an async_sempaphore
+    /// @param exec is the default executor associated with the async_semaphore
+    /// @param initial_count is the initial value of the internal counter.
+    /// @pre initial_count >= 0
+    /// @pre initial_count <= MAX_INT
+    ///
+    basic_async_semaphore(executor_type exec, int initial_count = 1);
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Initiate an asynchronous acquire of the semaphore
+    /// @details This function may be called from any thread. Semantics are
+    /// otherwise as for asioex::basic_async_semaphore::async_acquire.
+    /// @note Cancellation may be emitted from any thread, but, as for asio's
+    /// own I/O objects, must not race with the completion of the operation.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+    async_acquire(
+        CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Initiate an asynchronous acquire of n units of the semaphore
+    /// @param n is the number of units to acquire.
+    /// @pre n >= 0
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionHandler
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code))
+    async_acquire(
+        int n,
+        CompletionHandler &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    executor_type exec_;
+};
+
+using async_semaphore = basic_async_semaphore<>;
+
+}   // namespace mt
+}   // namespace asioex
+
+#endif
+
+#include <asioex/mt/impl/async_semaphore_base.hpp>
+#include <asioex/mt/impl/basic_async_semaphore.hpp>
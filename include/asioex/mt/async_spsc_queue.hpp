@@ -0,0 +1,294 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_MT_ASYNC_SPSC_QUEUE_HPP
+#define ASIOEX_MT_ASYNC_SPSC_QUEUE_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/queue_wait_handler.hpp>
+#include <asioex/detail/spsc_ring.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+namespace asioex
+{
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+}   // namespace detail
+
+namespace mt
+{
+/// @brief The executor-independent part of basic_async_spsc_queue.
+template < class T >
+struct async_spsc_queue_base
+{
+    inline explicit async_spsc_queue_base(std::size_t capacity);
+
+    async_spsc_queue_base(async_spsc_queue_base const &) ASIO_DELETED;
+
+    async_spsc_queue_base &
+    operator=(async_spsc_queue_base const &) ASIO_DELETED;
+
+    inline ~async_spsc_queue_base();
+
+    /// @brief Consumer: pop the front item into value if there is one.
+    inline bool
+    try_pop(T &value);
+
+    /// @brief Consumer: pop as many items as are available, up to
+    /// out.size(), into out.
+    /// @returns The number of items popped.
+    inline std::size_t
+    try_pop_some(std::span< T > out);
+
+    /// @brief The number of items the queue can hold, which is the capacity
+    /// it was constructed with rounded up to a power of two.
+    ASIO_NODISCARD inline std::size_t
+    capacity() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< async_spsc_queue_base >;
+
+    /// @brief A parked pop, which receives the item popped for it.
+    struct pop_action
+    {
+        bool
+        ready()
+        {
+            T value;
+            if (!queue_->ring_.try_pop(value))
+                return false;
+            value_.emplace(std::move(value));
+            return true;
+        }
+
+        template < class Handler >
+        void
+        complete(Handler &&handler, error_code ec)
+        {
+            if (value_)
+                std::move(handler)(ec, std::move(*value_));
+            else
+                std::move(handler)(ec, T());
+        }
+
+        async_spsc_queue_base *queue_;
+        std::optional< T >     value_ = std::nullopt;
+    };
+
+    /// @brief A parked batch pop, which receives the number of items popped
+    /// into its span.
+    struct pop_some_action
+    {
+        bool
+        ready()
+        {
+            count_ = queue_->ring_.try_pop_some(out_);
+            return count_ != 0;
+        }
+
+        template < class Handler >
+        void
+        complete(Handler &&handler, error_code ec)
+        {
+            std::move(handler)(ec, count_);
+        }
+
+        async_spsc_queue_base *queue_;
+        std::span< T >         out_;
+        std::size_t            count_ = 0;
+    };
+
+    /// @brief Consumer: park the consumer's only waiter.
+    /// @returns true if an item or a close was published in the meantime,
+    /// in which case the caller must deliver() at once.
+    /// @pre No other waiter is parked.
+    inline bool
+    park(wait_op *waiter);
+
+    /// @brief Producer: after publishing, claim the right to wake a parked
+    /// consumer.
+    /// @returns true if the caller must arrange for deliver() to be called
+    /// on the consumer's executor.
+    inline bool
+    claim_wakeup() noexcept;
+
+    /// @brief Producer: mark the queue closed.
+    inline void
+    mark_closed() noexcept;
+
+    ASIO_NODISCARD inline bool
+    is_closed() const noexcept;
+
+    /// @brief Consumer: resume the parked waiter, if any, with an item or
+    /// with error::eof, or re-arm it if there is nothing for it yet.
+    /// @param consumer_executor is the executor deliver() is running on.
+    /// @param may_invoke is true if deliver() is not being called from an
+    /// initiating function, so that a waiter whose handler uses
+    /// consumer_executor may be invoked inline rather than posted.
+    template < class Executor >
+    void
+    deliver(Executor const &consumer_executor, bool may_invoke);
+
+    detail::spsc_ring< T > ring_;
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    /// @brief Consumer: publish interest in a wakeup and then check whether
+    /// one is already due.
+    /// @returns true if the consumer took its own wakeup back and must
+    /// deliver now.
+    inline bool
+    arm() noexcept;
+
+    std::atomic< bool > closed_;
+    std::atomic< bool > consumer_parked_;
+    wait_op            *waiter_;
+    wait_op_pool_stats  pool_stats_;
+};
+
+/// @brief A bounded queue between exactly one producer thread and one
+/// consumer, built on a lock-free ring.
+/// @details The producer calls try_push, try_push_some and close. These never
+/// block and never take a lock. They return false, or 0, when the queue is
+/// full.
+///
+/// The consumer calls try_pop, try_pop_some, async_pop and async_pop_some.
+/// It must run on the queue's executor, which must not run handlers
+/// concurrently, so a single threaded io_context or a strand.
+///
+/// An async pop is only parked when the queue is empty. Waking it costs the
+/// producer one post to the queue's executor. A producer which pushes into a
+/// queue without a parked consumer pays one fence and one load on top of the
+/// ring.
+///
+/// Like basic_async_semaphore::release_from_any_thread, a wakeup refers to
+/// the queue, so the producer must have stopped, and the queue's executor
+/// must have run the last wakeup, before the queue is destroyed.
+template < class T, class Executor = asio::any_io_executor >
+struct basic_async_spsc_queue : async_spsc_queue_base< T >
+{
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// @brief The type of the items.
+    using value_type = T;
+
+    /// Rebinds the queue type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The queue type when rebound to the specified executor.
+        typedef basic_async_spsc_queue< T, Executor1 > other;
+    };
+
+    /// @brief Construct an async_spsc_queue
+    /// @param exec is the executor on which the consumer runs.
+    /// @param capacity is rounded up to a power of two.
+    /// @pre capacity > 0
+    basic_async_spsc_queue(executor_type exec, std::size_t capacity);
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Producer: push value if there is room.
+    /// @returns true if value was pushed. value is only moved from if so.
+    bool
+    try_push(T &&value);
+
+    /// @brief Producer: move as many items from the front of in as there is
+    /// room for, and publish them together.
+    /// @returns The number of items pushed.
+    std::size_t
+    try_push_some(std::span< T > in);
+
+    /// @brief Producer: close the queue.
+    /// @details Items already pushed can still be popped, after which pops
+    /// fail with error::eof. Nothing may be pushed after close.
+    void
+    close();
+
+    /// @brief Consumer: initiate an asynchronous pop of the front item.
+    /// @details Completes with the item, or with error::eof once the queue
+    /// is closed and empty. At most one async_pop or async_pop_some may be
+    /// outstanding at a time.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, T)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, T))
+    async_pop(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Consumer: initiate an asynchronous pop of between 1 and
+    /// out.size() items into out.
+    /// @details Completes with the number of items popped, or with
+    /// error::eof once the queue is closed and empty.
+    /// @note out must remain valid until the operation completes.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, std::size_t))
+                   CompletionToken
+                       ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, std::size_t))
+    async_pop_some(std::span< T > out,
+                   CompletionToken &&token
+                       ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    using base_type = async_spsc_queue_base< T >;
+
+    void
+    wake();
+
+    template < class Action, class AssociatedExecutor, class Handler >
+    void
+    park_consumer(Action &&action, AssociatedExecutor e, Handler &&handler);
+
+    executor_type exec_;
+};
+
+template < class T >
+using async_spsc_queue = basic_async_spsc_queue< T >;
+
+}   // namespace mt
+}   // namespace asioex
+
+#endif
+
+#include <asioex/mt/impl/async_spsc_queue_base.hpp>
+#include <asioex/mt/impl/basic_async_spsc_queue.hpp>
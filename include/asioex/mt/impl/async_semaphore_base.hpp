@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_MT_IMPL_ASYNC_SEMAPHORE_BASE_HPP
+#define ASIOEX_MT_IMPL_ASYNC_SEMAPHORE_BASE_HPP
+
+#include <asio/error.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+#include <asioex/mt/async_semaphore.hpp>
+
+namespace asioex::mt
+{
+// Ordering: a parking acquirer adds to waiting_ and then re-reads count_,
+// whereas release() increments count_ and then reads waiting_. Both sides use
+// sequentially consistent operations so at least one of them observes the
+// other, which means a permit can never be stranded while a waiter is parked.
+
+async_semaphore_base::async_semaphore_base(int initial_count)
+: count_(initial_count)
+, waiting_(0)
+, mutex_()
+, waiters_()
+, pool_hits_(0)
+, pool_misses_(0)
+{
+}
+
+async_semaphore_base::~async_semaphore_base()
+{
+    auto lock = std::lock_guard< std::mutex >(mutex_);
+    detail::complete_all< async_semaphore_base >(
+        waiters_, asio::error::operation_aborted);
+    waiting_ = 0;
+}
+
+void
+async_semaphore_base::add_waiter(wait_op *waiter)
+{
+    {
+        auto lock = std::lock_guard< std::mutex >(mutex_);
+        waiting_.fetch_add(waiter->requested_);
+        if (!try_acquire(waiter->requested_))
+        {
+            waiters_.push_back(waiter);
+            return;
+        }
+        waiting_.fetch_sub(waiter->requested_);
+    }
+
+    // a release() raced with us and the count is ours after all
+    waiter->complete(error_code());
+}
+
+void
+async_semaphore_base::cancel_waiter(wait_op *waiter)
+{
+    bool was_front;
+    {
+        auto lock = std::lock_guard< std::mutex >(mutex_);
+
+        // a self-linked op has not yet been queued, and a dequeued one is
+        // being completed by another thread, maybe from a local list
+        if (waiter->next_ == waiter || waiter->dequeued_)
+            return;
+        was_front = waiters_.front() == waiter;
+        waiters_.erase(waiter);
+        waiting_.fetch_sub(waiter->requested_);
+    }
+    waiter->complete(asio::error::operation_aborted);
+
+    // the cancelled op may have been holding back smaller requests
+    if (was_front)
+        notify_waiters();
+}
+
+void
+async_semaphore_base::release(int n)
+{
+    count_.fetch_add(n);
+    if (waiting_.load() != 0)
+        notify_waiters();
+}
+
+void
+async_semaphore_base::notify_waiters()
+{
+    // pair free counts with waiters under the lock, but invoke the
+    // completions outside it
+    detail::sized_bilist ready;
+    {
+        auto lock = std::lock_guard< std::mutex >(mutex_);
+        while (!waiters_.empty() &&
+               try_acquire(static_cast< wait_op * >(waiters_.front())
+                               ->requested_))
+        {
+            auto op = static_cast< wait_op * >(waiters_.pop_front());
+            waiting_.fetch_sub(op->requested_);
+            op->dequeued_ = true;
+            ready.push_back(op);
+        }
+    }
+
+    detail::complete_all< async_semaphore_base >(ready, error_code());
+}
+
+std::size_t
+async_semaphore_base::release_all()
+{
+    detail::sized_bilist ready;
+    int                  released;
+    {
+        auto lock = std::lock_guard< std::mutex >(mutex_);
+        if (waiters_.empty())
+            return 0u;
+
+        // every waiter is satisfied, which leaves the count at zero
+        released = waiting_.exchange(0) - count_.exchange(0);
+        if (released < 0)
+        {
+            count_.fetch_add(-released);
+            released = 0;
+        }
+        while (!waiters_.empty())
+        {
+            auto op       = static_cast< wait_op * >(waiters_.pop_front());
+            op->dequeued_ = true;
+            ready.push_back(op);
+        }
+    }
+
+    detail::complete_all< async_semaphore_base >(ready, error_code());
+    return static_cast< std::size_t >(released);
+}
+
+void
+async_semaphore_base::record_pool_allocation(bool hit) noexcept
+{
+    (hit ? pool_hits_ : pool_misses_).fetch_add(1, std::memory_order_relaxed);
+}
+
+wait_op_pool_stats
+async_semaphore_base::pool_stats() const noexcept
+{
+    wait_op_pool_stats result;
+    result.hits   = pool_hits_.load(std::memory_order_relaxed);
+    result.misses = pool_misses_.load(std::memory_order_relaxed);
+    return result;
+}
+
+int
+async_semaphore_base::value() const noexcept
+{
+    return count_.load() - waiting_.load();
+}
+
+bool
+async_semaphore_base::try_acquire(int n)
+{
+    auto c = count_.load();
+    while (c >= n)
+        if (count_.compare_exchange_weak(c, c - n))
+            return true;
+    return false;
+}
+
+}   // namespace asioex::mt
+
+#endif
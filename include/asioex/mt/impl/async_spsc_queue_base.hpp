@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_MT_IMPL_ASYNC_SPSC_QUEUE_BASE_HPP
+#define ASIOEX_MT_IMPL_ASYNC_SPSC_QUEUE_BASE_HPP
+
+#include <asio/detail/assert.hpp>
+#include <asio/error.hpp>
+#include <asioex/detail/semaphore_wait_op.hpp>
+#include <asioex/mt/async_spsc_queue.hpp>
+
+#include <typeinfo>
+
+namespace asioex::mt
+{
+template < class T >
+async_spsc_queue_base< T >::async_spsc_queue_base(std::size_t capacity)
+: ring_(capacity)
+, closed_(false)
+, consumer_parked_(false)
+, waiter_(nullptr)
+, pool_stats_()
+{
+}
+
+template < class T >
+async_spsc_queue_base< T >::~async_spsc_queue_base()
+{
+    if (auto op = std::exchange(waiter_, nullptr))
+        op->complete(asio::error::operation_aborted);
+}
+
+template < class T >
+bool
+async_spsc_queue_base< T >::try_pop(T &value)
+{
+    return ring_.try_pop(value);
+}
+
+template < class T >
+std::size_t
+async_spsc_queue_base< T >::try_pop_some(std::span< T > out)
+{
+    return ring_.try_pop_some(out);
+}
+
+template < class T >
+std::size_t
+async_spsc_queue_base< T >::capacity() const noexcept
+{
+    return ring_.capacity();
+}
+
+template < class T >
+wait_op_pool_stats
+async_spsc_queue_base< T >::pool_stats() const noexcept
+{
+    return pool_stats_;
+}
+
+template < class T >
+bool
+async_spsc_queue_base< T >::park(wait_op *waiter)
+{
+    ASIO_ASSERT(!waiter_);
+    waiter_ = waiter;
+    return arm();
+}
+
+template < class T >
+bool
+async_spsc_queue_base< T >::claim_wakeup() noexcept
+{
+    // pairs with the fence in arm(): either the consumer sees what was just
+    // published, or this sees that the consumer is parked, or both
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return consumer_parked_.load(std::memory_order_relaxed) &&
+           consumer_parked_.exchange(false, std::memory_order_acq_rel);
+}
+
+template < class T >
+void
+async_spsc_queue_base< T >::mark_closed() noexcept
+{
+    closed_.store(true, std::memory_order_release);
+}
+
+template < class T >
+bool
+async_spsc_queue_base< T >::is_closed() const noexcept
+{
+    return closed_.load(std::memory_order_acquire);
+}
+
+template < class T >
+template < class Executor >
+void
+async_spsc_queue_base< T >::deliver(Executor const &consumer_executor,
+                                    bool            may_invoke)
+{
+    auto op = waiter_;
+    if (!op)
+        return;
+
+    error_code ec;
+    while (!op->ready())
+    {
+        // close is published after the last push, so an item pushed before
+        // it is visible once the close is
+        if (is_closed())
+        {
+            if (!op->ready())
+                ec = asio::error::eof;
+            break;
+        }
+
+        // a wakeup can be stale, for example if try_pop took the item
+        if (!arm())
+            return;
+    }
+
+    waiter_ = nullptr;
+    if (may_invoke &&
+        op->uses_executor(typeid(Executor), &consumer_executor))
+        op->invoke(ec);
+    else
+        op->complete(ec);
+}
+
+template < class T >
+void
+async_spsc_queue_base< T >::cancel_waiter(wait_op *waiter)
+{
+    ASIO_ASSERT(waiter_ == waiter);
+    waiter_ = nullptr;
+
+    // a wakeup claimed for this waiter finds none and does nothing
+    waiter->complete(asio::error::operation_aborted);
+}
+
+template < class T >
+void
+async_spsc_queue_base< T >::record_pool_allocation(bool hit) noexcept
+{
+    if (hit)
+        ++pool_stats_.hits;
+    else
+        ++pool_stats_.misses;
+}
+
+template < class T >
+bool
+async_spsc_queue_base< T >::arm() noexcept
+{
+    consumer_parked_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring_.empty() && !is_closed())
+        return false;
+
+    // if the producer has already claimed the wakeup it will post it
+    return consumer_parked_.exchange(false, std::memory_order_acq_rel);
+}
+
+}   // namespace asioex::mt
+
+#endif
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_MT_IMPL_BASIC_ASYNC_SPSC_QUEUE_HPP
+#define ASIOEX_MT_IMPL_BASIC_ASYNC_SPSC_QUEUE_HPP
+
+#include <asio/error.hpp>
+#include <asio/post.hpp>
+#include <asioex/detail/semaphore_wait_op_model.hpp>
+#include <asioex/immediate.hpp>
+#include <asioex/mt/async_spsc_queue.hpp>
+
+namespace asioex::mt
+{
+template < class T, class Executor >
+basic_async_spsc_queue< T, Executor >::basic_async_spsc_queue(
+    executor_type exec,
+    std::size_t   capacity)
+: base_type(capacity)
+, exec_(std::move(exec))
+{
+}
+
+template < class T, class Executor >
+typename basic_async_spsc_queue< T, Executor >::executor_type const &
+basic_async_spsc_queue< T, Executor >::get_executor() const
+{
+    return exec_;
+}
+
+template < class T, class Executor >
+bool
+basic_async_spsc_queue< T, Executor >::try_push(T &&value)
+{
+    if (!this->ring_.try_push(std::move(value)))
+        return false;
+    wake();
+    return true;
+}
+
+template < class T, class Executor >
+std::size_t
+basic_async_spsc_queue< T, Executor >::try_push_some(std::span< T > in)
+{
+    auto n = this->ring_.try_push_some(in);
+    if (n)
+        wake();
+    return n;
+}
+
+template < class T, class Executor >
+void
+basic_async_spsc_queue< T, Executor >::close()
+{
+    this->mark_closed();
+    wake();
+}
+
+template < class T, class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, T)) CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, T))
+basic_async_spsc_queue< T, Executor >::async_pop(CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken, void(std::error_code, T) >(
+        [this]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            // close is published after the last push, so look again once
+            // it is seen
+            T    value;
+            auto got = this->try_pop(value);
+            if (!got && this->is_closed())
+                got = this->try_pop(value);
+            if (got || this->is_closed())
+            {
+                detail::complete_now(
+                    e,
+                    std::forward< Handler >(handler),
+                    got ? error_code() : error_code(asio::error::eof),
+                    std::move(value));
+                return;
+            }
+
+            park_consumer(typename base_type::pop_action { this },
+                          std::move(e),
+                          std::forward< Handler >(handler));
+        },
+        token);
+}
+
+template < class T, class Executor >
+template < ASIO_COMPLETION_TOKEN_FOR(void(error_code, std::size_t))
+               CompletionToken >
+ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, std::size_t))
+basic_async_spsc_queue< T, Executor >::async_pop_some(
+    std::span< T >    out,
+    CompletionToken &&token)
+{
+    return asio::async_initiate< CompletionToken,
+                                 void(std::error_code, std::size_t) >(
+        [this, out]< class Handler >(Handler &&handler)
+        {
+            auto e = get_associated_executor(handler, get_executor());
+            auto n = this->try_pop_some(out);
+            if (!n && this->is_closed())
+                n = this->try_pop_some(out);
+            if (n || out.empty() || this->is_closed())
+            {
+                detail::complete_now(
+                    e,
+                    std::forward< Handler >(handler),
+                    n || out.empty() ? error_code()
+                                     : error_code(asio::error::eof),
+                    n);
+                return;
+            }
+
+            park_consumer(typename base_type::pop_some_action { this, out },
+                          std::move(e),
+                          std::forward< Handler >(handler));
+        },
+        token);
+}
+
+template < class T, class Executor >
+void
+basic_async_spsc_queue< T, Executor >::wake()
+{
+    if (this->claim_wakeup())
+        asio::post(exec_, [this] { this->deliver(exec_, true); });
+}
+
+template < class T, class Executor >
+template < class Action, class AssociatedExecutor, class Handler >
+void
+basic_async_spsc_queue< T, Executor >::park_consumer(Action &&action,
+                                                     AssociatedExecutor e,
+                                                     Handler &&handler)
+{
+    using handler_type = detail::queue_wait_handler< std::decay_t< Action >,
+                                                     std::decay_t< Handler > >;
+    using model_type   = detail::
+        semaphore_wait_op_model< AssociatedExecutor, handler_type, base_type >;
+    auto model =
+        model_type::construct(this,
+                              0,
+                              std::move(e),
+                              handler_type(std::forward< Action >(action),
+                                           std::forward< Handler >(handler)));
+    if (this->park(model))
+        this->deliver(exec_, false);
+}
+
+}   // namespace asioex::mt
+
+#endif
@@ -6,20 +6,44 @@
 #define ASIO_EXPERIMENTS_MUTEX_HPP
 
 #include <asioex/async_semaphore.hpp>
+#include <asioex/sync_stats.hpp>
 #include <asio/experimental/append.hpp>
 #include <asio/compose.hpp>
 
+#include <chrono>
+
 
 namespace asioex
 {
 
-template<typename Executor = asio::any_io_executor>
+/// @brief How a basic_mutex passes ownership on unlock.
+enum class mutex_mode
+{
+    /// unlock() hands the mutex directly to the least recent waiter, which
+    /// resumes already owning it. Nobody can take the mutex in between, so
+    /// waiters are served in strict FIFO order.
+    handoff,
+
+    /// unlock() frees the mutex and wakes the least recent waiter, which then
+    /// competes for it again. A newcomer may take the mutex first. This
+    /// favours throughput over fairness.
+    barging
+};
+
+/// @tparam StatsPolicy decides which contention statistics are kept. Either
+/// null_sync_stats (the default), which keeps none at no cost, or sync_stats.
+template<typename Executor = asio::any_io_executor,
+         typename StatsPolicy = null_sync_stats>
 struct basic_mutex
 {
     using executor_type = Executor;
 
-    explicit basic_mutex(executor_type exec)
-    : semaphore_(std::move(exec))
+    /// @brief The policy which keeps contention statistics.
+    using stats_policy = StatsPolicy;
+
+    explicit basic_mutex(executor_type exec, mutex_mode mode = mutex_mode::handoff)
+    : mode_(mode)
+    , semaphore_(std::move(exec), mode == mutex_mode::handoff ? 1 : 0)
     {
     }
 
@@ -28,9 +52,45 @@ struct basic_mutex
     ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
     async_lock(CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type))
     {
+        // in handoff mode the semaphore's single unit is the lock
+        if (mode_ == mutex_mode::handoff)
+        {
+            if constexpr (StatsPolicy::enabled)
+                return asio::async_initiate<CompletionToken, void(error_code)>(
+                    [this]<class Handler>(Handler&& handler)
+                    {
+                        stats_.on_acquire();
+                        // only one unit and no banking, so this is exactly
+                        // when the semaphore will not park
+                        if (semaphore_.value() > 0)
+                        {
+                            stats_.on_fast_path();
+                            semaphore_.async_acquire(std::forward<Handler>(handler));
+                        }
+                        else
+                            semaphore_.async_acquire(stats_.on_park(
+                                semaphore_.waiters() + 1, std::forward<Handler>(handler)));
+                    }, token);
+            else
+                return semaphore_.async_acquire(std::forward<CompletionToken>(token));
+        }
+
+        // a waiter may park several times, so the wait is timed here rather
+        // than by the handler which on_park would wrap
+        using clock = std::chrono::steady_clock;
         return asio::async_compose<CompletionToken, void(error_code)>(
-            [&, did_suspend = false](auto& self, error_code ec = {}) mutable
+            [&, did_suspend = false, parked_at = clock::time_point()](
+                auto& self, error_code ec = {}) mutable
             {
+                if (!did_suspend && !ec)
+                    stats_.on_acquire();
+
+                if (did_suspend && (ec || !locked_))
+                {
+                    if constexpr (StatsPolicy::enabled)
+                        stats_.on_wait(clock::now() - parked_at, ec);
+                }
+
                 if (ec)
                     std::move(self).complete(ec);
                 else if (!locked_)
@@ -39,15 +99,28 @@ struct basic_mutex
                     if (did_suspend)
                         std::move(self).complete(ec);
                     else
+                    {
+                        stats_.on_fast_path();
                         asio::post(
                             get_associated_executor(self, get_executor()),
                             [s = std::move(self)]() mutable
                             {
                                 std::move(s).complete(error_code{});
                             });
+                    }
                 }
                 else
                 {
+                    // a waiter which lost the mutex to a newcomer parks
+                    // again, which is still the same wait
+                    if (did_suspend)
+                        stats_.on_requeue(semaphore_.waiters() + 1);
+                    else
+                    {
+                        stats_.on_park(semaphore_.waiters() + 1);
+                        if constexpr (StatsPolicy::enabled)
+                            parked_at = clock::now();
+                    }
                     did_suspend = true;
                     semaphore_.async_acquire(std::move(self));
                 }
@@ -57,14 +130,35 @@ struct basic_mutex
     void
     unlock()
     {
+        if (mode_ == mutex_mode::handoff)
+        {
+            semaphore_.release();
+            return;
+        }
+
         locked_ = false;
-        semaphore_.release();
+        // only wake a waiter if there is one, otherwise the semaphore would
+        // bank a wakeup for some future waiter
+        if (semaphore_.value() < 0)
+            semaphore_.release();
     }
 
+    /// @brief Take the mutex if it is free.
+    /// @returns true if the mutex was acquired.
     bool
     try_lock()
     {
-        return std::exchange(locked_, true);
+        if (mode_ == mutex_mode::handoff)
+            return semaphore_.try_acquire();
+        return !std::exchange(locked_, true);
+    }
+
+    /// @brief A copy of the contention statistics kept so far.
+    /// @details All zero unless StatsPolicy keeps statistics.
+    sync_stats_snapshot
+    stats() const noexcept
+    {
+        return stats_.snapshot();
     }
 
     /// Rebinds the mutex type to another executor.
@@ -72,24 +166,27 @@ struct basic_mutex
     struct rebind_executor
     {
         /// The mutex type when rebound to the specified executor.
-        typedef basic_mutex<Executor1> other;
+        typedef basic_mutex<Executor1, StatsPolicy> other;
     };
 
-    template<typename Executor_>
-    friend class basic_mutex;
+    template<typename Executor_, typename StatsPolicy_>
+    friend struct basic_mutex;
 
     /// @brief return the default executor.
     executor_type const &
     get_executor() const {return semaphore_.get_executor();}
 
   private:
+    mutex_mode        mode_;
     bool              locked_ = false;
     basic_async_semaphore<Executor> semaphore_;
+    [[no_unique_address]] StatsPolicy stats_;
 };
 
 using mutex = basic_mutex<>;
 
-template<typename Executor = asio::any_io_executor>
+template<typename Executor = asio::any_io_executor,
+         typename StatsPolicy = null_sync_stats>
 struct basic_lock_guard
 {
     basic_lock_guard(const basic_lock_guard &) = delete;
@@ -113,33 +210,33 @@ struct basic_lock_guard
             mtx_->unlock();
     }
 
-    template<typename Executor_,  ASIO_COMPLETION_TOKEN_FOR(void(error_code, basic_lock_guard<Executor_>)) CompletionHandler>
-    friend ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code, basic_lock_guard<Executor_>))
-    async_guard(basic_mutex<Executor_> &mtx, CompletionHandler &&token);
+    template<typename Executor_, typename StatsPolicy_,  ASIO_COMPLETION_TOKEN_FOR(void(error_code, basic_lock_guard<Executor_, StatsPolicy_>)) CompletionHandler>
+    friend ASIO_INITFN_RESULT_TYPE(CompletionHandler, void(error_code, basic_lock_guard<Executor_, StatsPolicy_>))
+    async_guard(basic_mutex<Executor_, StatsPolicy_> &mtx, CompletionHandler &&token);
 
   private:
-    basic_lock_guard(basic_mutex<Executor> *mtx)
+    basic_lock_guard(basic_mutex<Executor, StatsPolicy> *mtx)
     : mtx_(mtx)
     {
     }
-    basic_mutex<Executor> *mtx_ = nullptr;
+    basic_mutex<Executor, StatsPolicy> *mtx_ = nullptr;
 };
 
 using lock_guard = basic_lock_guard<>;
 
-template<typename Executor,  ASIO_COMPLETION_TOKEN_FOR(void(error_code, basic_lock_guard<Executor>)) CompletionToken
+template<typename Executor, typename StatsPolicy,  ASIO_COMPLETION_TOKEN_FOR(void(error_code, basic_lock_guard<Executor, StatsPolicy>)) CompletionToken
                ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor) >
-inline ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, basic_lock_guard<Executor>))
-    async_guard(basic_mutex<Executor> &mtx,
+inline ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code, basic_lock_guard<Executor, StatsPolicy>))
+    async_guard(basic_mutex<Executor, StatsPolicy> &mtx,
                 CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(Executor))
 {
-    return asio::async_compose<CompletionToken, void(error_code, basic_lock_guard<Executor>)>(
+    return asio::async_compose<CompletionToken, void(error_code, basic_lock_guard<Executor, StatsPolicy>)>(
             [&](auto& self)
             {
                 mtx.async_lock(
                     [&, s = std::move(self)](error_code ec) mutable
                     {
-                        std::move(s).complete(ec, basic_lock_guard<Executor>(&mtx));
+                        std::move(s).complete(ec, basic_lock_guard<Executor, StatsPolicy>(&mtx));
                     });
             }, token, mtx);
 //    return mtx.async_lock(asio::experimental::append(basic_lock_guard<Executor>(&mtx)))(std::forward<CompletionHandler>(token));
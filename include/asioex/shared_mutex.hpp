@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_SHARED_MUTEX_HPP
+#define ASIOEX_SHARED_MUTEX_HPP
+
+#include <asio/any_io_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detail/config.hpp>
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/detail/wait_op_pool.hpp>
+#include <asioex/error_code.hpp>
+
+#include <cstddef>
+#include <utility>
+
+namespace asioex
+{
+struct shared_mutex_base;
+
+namespace detail
+{
+template < class Host >
+struct basic_semaphore_wait_op;
+
+template < class Executor, class Handler, class Host >
+struct semaphore_wait_op_model;
+
+template < class Host >
+struct semaphore_cancel_handler;
+}   // namespace detail
+
+/// @brief The executor-independent part of basic_shared_mutex.
+/// @details The mutex has three levels of ownership:
+///  - shared, held by any number of readers at once,
+///  - upgrade, held by at most one owner at a time alongside readers, which
+///    may later be converted to exclusive ownership without giving it up,
+///  - exclusive, held by one writer and nobody else.
+///
+/// Writers are preferred: once an exclusive or upgrade-to-exclusive request is
+/// queued, no new shared or upgrade ownership is granted until it has been
+/// served. This prevents a steady stream of readers from starving writers.
+struct shared_mutex_base
+{
+    inline shared_mutex_base();
+
+    shared_mutex_base(shared_mutex_base const &) ASIO_DELETED;
+
+    shared_mutex_base &
+    operator=(shared_mutex_base const &) ASIO_DELETED;
+
+    inline ~shared_mutex_base();
+
+    /// @brief Take exclusive ownership if it is immediately available.
+    inline bool
+    try_lock();
+
+    /// @brief Take shared ownership if it is immediately available.
+    inline bool
+    try_lock_shared();
+
+    /// @brief Take upgrade ownership if it is immediately available.
+    inline bool
+    try_lock_upgrade();
+
+    /// @brief Release exclusive ownership.
+    inline void
+    unlock();
+
+    /// @brief Release shared ownership.
+    inline void
+    unlock_shared();
+
+    /// @brief Release upgrade ownership.
+    inline void
+    unlock_upgrade();
+
+    /// @brief Atomically convert exclusive ownership into shared ownership.
+    inline void
+    unlock_and_lock_shared();
+
+    /// @brief The number of current shared owners.
+    ASIO_NODISCARD inline std::size_t
+    shared_count() const noexcept;
+
+    /// @brief How many wait ops were served from the per-thread pool rather
+    /// than freshly allocated.
+    ASIO_NODISCARD inline wait_op_pool_stats
+    pool_stats() const noexcept;
+
+  protected:
+    using wait_op = detail::basic_semaphore_wait_op< shared_mutex_base >;
+
+    /// @brief The ownership a wait op is queued for, stored in the op's
+    /// requested_ member.
+    enum lock_kind : int
+    {
+        shared_lock,
+        exclusive_lock,
+        upgrade_lock,
+        upgrading_lock
+    };
+
+    /// @brief Take ownership of the given kind if it can be granted now
+    /// without overtaking a queued waiter of the same kind.
+    inline bool
+    try_acquire(lock_kind kind);
+
+    inline void
+    add_waiter(wait_op *waiter);
+
+  private:
+    template < class Executor, class Handler, class Host >
+    friend struct detail::semaphore_wait_op_model;
+
+    template < class Host >
+    friend struct detail::semaphore_cancel_handler;
+
+    inline void
+    cancel_waiter(wait_op *waiter);
+
+    inline void
+    record_pool_allocation(bool hit) noexcept;
+
+    /// @brief Take ownership of the given kind if the current owners allow it.
+    inline bool
+    try_grant(lock_kind kind);
+
+    /// @brief Grant ownership to as many waiters as the state now allows.
+    inline void
+    notify();
+
+    std::size_t          shared_;
+    bool                 exclusive_;
+    bool                 upgrade_;
+    wait_op             *upgrading_;
+    detail::sized_bilist shared_waiters_;
+    detail::sized_bilist exclusive_waiters_;
+    detail::sized_bilist upgrade_waiters_;
+    wait_op_pool_stats   pool_stats_;
+};
+
+/// @brief An asynchronous reader/writer mutex.
+/// @details Like basic_async_semaphore, this object is not thread-safe. All
+/// completions are delivered as if by `post`, or `dispatch` for tokens adapted
+/// with asioex::immediate when ownership is granted at initiation.
+template < class Executor = asio::any_io_executor >
+struct basic_shared_mutex : shared_mutex_base
+{
+    /// @brief The type of the default executor.
+    using executor_type = Executor;
+
+    /// Rebinds the mutex type to another executor.
+    template < typename Executor1 >
+    struct rebind_executor
+    {
+        /// The mutex type when rebound to the specified executor.
+        typedef basic_shared_mutex< Executor1 > other;
+    };
+
+    explicit basic_shared_mutex(executor_type exec);
+
+    /// @brief return the default executor.
+    executor_type const &
+    get_executor() const;
+
+    /// @brief Asynchronously acquire exclusive ownership.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_lock(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Asynchronously acquire shared ownership.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_lock_shared(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Asynchronously acquire upgrade ownership.
+    /// @details Upgrade ownership coexists with shared owners but excludes
+    /// writers and other upgrade owners.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_lock_upgrade(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+    /// @brief Asynchronously convert upgrade ownership into exclusive
+    /// ownership.
+    /// @details Completes once all shared owners have left. While the upgrade
+    /// is pending no new shared ownership is granted. If the operation fails
+    /// the caller retains upgrade ownership.
+    /// @pre The caller holds upgrade ownership.
+    template < ASIO_COMPLETION_TOKEN_FOR(void(error_code)) CompletionToken
+                   ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(executor_type) >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_upgrade(
+        CompletionToken &&token ASIO_DEFAULT_COMPLETION_TOKEN(executor_type));
+
+  private:
+    template < class CompletionToken >
+    ASIO_INITFN_RESULT_TYPE(CompletionToken, void(error_code))
+    async_wait_for(lock_kind kind, CompletionToken &&token);
+
+    executor_type exec_;
+};
+
+using shared_mutex = basic_shared_mutex<>;
+
+/// @brief Holds shared ownership of a basic_shared_mutex and releases it on
+/// destruction.
+template < typename Executor = asio::any_io_executor >
+struct basic_shared_lock_guard
+{
+    basic_shared_lock_guard(const basic_shared_lock_guard &) = delete;
+    basic_shared_lock_guard(basic_shared_lock_guard &&lhs)
+    : mtx_(std::exchange(lhs.mtx_, nullptr))
+    {
+    }
+
+    basic_shared_lock_guard &
+    operator=(const basic_shared_lock_guard &) = delete;
+    basic_shared_lock_guard &
+    operator=(basic_shared_lock_guard &&lhs)
+    {
+        std::swap(lhs.mtx_, mtx_);
+        return *this;
+    }
+
+    ~basic_shared_lock_guard()
+    {
+        if (mtx_)
+            mtx_->unlock_shared();
+    }
+
+    template < typename Executor_,
+               ASIO_COMPLETION_TOKEN_FOR(
+                   void(error_code, basic_shared_lock_guard< Executor_ >))
+                   CompletionToken >
+    friend ASIO_INITFN_RESULT_TYPE(
+        CompletionToken,
+        void(error_code, basic_shared_lock_guard< Executor_ >))
+        async_shared_guard(basic_shared_mutex< Executor_ > &mtx,
+                           CompletionToken                &&token);
+
+  private:
+    basic_shared_lock_guard(basic_shared_mutex< Executor > *mtx)
+    : mtx_(mtx)
+    {
+    }
+    basic_shared_mutex< Executor > *mtx_ = nullptr;
+};
+
+using shared_lock_guard = basic_shared_lock_guard<>;
+
+/// @brief Asynchronously acquire shared ownership of mtx, delivering a guard
+/// which releases it.
+template < typename Executor,
+           ASIO_COMPLETION_TOKEN_FOR(
+               void(error_code, basic_shared_lock_guard< Executor >))
+               CompletionToken ASIO_DEFAULT_COMPLETION_TOKEN_TYPE(Executor) >
+ASIO_INITFN_RESULT_TYPE(CompletionToken,
+                        void(error_code, basic_shared_lock_guard< Executor >))
+async_shared_guard(
+    basic_shared_mutex< Executor > &mtx,
+    CompletionToken &&token         ASIO_DEFAULT_COMPLETION_TOKEN(Executor));
+
+}   // namespace asioex
+
+#endif
+
+#include <asioex/impl/basic_shared_mutex.hpp>
+#include <asioex/impl/shared_mutex_base.hpp>
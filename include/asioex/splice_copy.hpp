@@ -0,0 +1,260 @@
+// Copyright (c) 2021 Klemens D. Morgenstern
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#ifndef ASIO_EXPERIMENTS_SPLICE_COPY_HPP
+#define ASIO_EXPERIMENTS_SPLICE_COPY_HPP
+
+#include <asio/async_result.hpp>
+#include <asio/basic_stream_socket.hpp>
+#include <asio/buffer.hpp>
+#include <asio/compose.hpp>
+#include <asio/error.hpp>
+#include <asio/experimental/append.hpp>
+#include <asio/experimental/prepend.hpp>
+#include <asio/post.hpp>
+#include <asio/write.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#define ASIOEX_HAS_SPLICE 1
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace asioex
+{
+
+namespace detail
+{
+
+// Copies through a user-space buffer, for when splice cannot be used.
+template<typename Source, typename Sink>
+struct buffered_copy_op
+{
+    static constexpr std::size_t buffer_size = 65536u;
+
+    Source & source;
+    Sink & sink;
+    std::unique_ptr<char[]> buffer{new char[buffer_size]};
+    std::size_t completed = 0u;
+    struct read_tag{};
+    struct write_tag{};
+
+    template<typename Self>
+    void operator()(Self && self)
+    {
+        // self owns the buffer, so take it before self is moved
+        auto buf = asio::buffer(buffer.get(), buffer_size);
+        source.async_read_some(buf, asio::experimental::prepend(std::move(self), read_tag{}));
+    }
+
+    template<typename Self>
+    void operator()(Self && self, read_tag, asio::error_code ec, std::size_t n)
+    {
+        if (ec)
+            return self.complete(ec, completed);
+        auto buf = asio::buffer(buffer.get(), n);
+        asio::async_write(sink, buf, asio::experimental::prepend(std::move(self), write_tag{}));
+    }
+
+    template<typename Self>
+    void operator()(Self && self, write_tag, asio::error_code ec, std::size_t n)
+    {
+        completed += n;
+        if (!ec && self.get_cancellation_state().cancelled() != asio::cancellation_type::none)
+            ec = asio::error::operation_aborted;
+        if (ec)
+            return self.complete(ec, completed);
+        (*this)(std::move(self));
+    }
+};
+
+template<typename Source, typename Sink>
+struct is_splice_capable : std::false_type {};
+
+#if defined(ASIOEX_HAS_SPLICE)
+
+template<typename Protocol1, typename Executor1, typename Protocol2, typename Executor2>
+struct is_splice_capable<asio::basic_stream_socket<Protocol1, Executor1>,
+                         asio::basic_stream_socket<Protocol2, Executor2>> : std::true_type {};
+
+// The pipe that the data passes through inside the kernel.
+struct splice_pipe
+{
+    int read_end = -1;
+    int write_end = -1;
+
+    splice_pipe() = default;
+    splice_pipe(splice_pipe && lhs) noexcept
+        : read_end(std::exchange(lhs.read_end, -1)), write_end(std::exchange(lhs.write_end, -1))
+    {
+    }
+    splice_pipe& operator=(splice_pipe &&) = delete;
+
+    ~splice_pipe()
+    {
+        if (read_end != -1)
+            ::close(read_end);
+        if (write_end != -1)
+            ::close(write_end);
+    }
+
+    // returns the capacity of the pipe
+    std::size_t open(asio::error_code & ec)
+    {
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0)
+        {
+            ec.assign(errno, asio::error::get_system_category());
+            return 0u;
+        }
+        read_end = fds[0];
+        write_end = fds[1];
+
+        // a larger pipe means fewer wakeups; this is only a hint
+        ::fcntl(write_end, F_SETPIPE_SZ, 1 << 20);
+        auto sz = ::fcntl(write_end, F_GETPIPE_SZ);
+        return sz > 0 ? std::size_t(sz) : 65536u;
+    }
+};
+
+// Moves data from source into the pipe and from the pipe into sink without
+// it ever reaching user space. Both sockets are switched to non-blocking mode.
+template<typename Source, typename Sink>
+struct splice_copy_op
+{
+    // how many rounds to splice before returning to the event loop
+    static constexpr int max_rounds = 16;
+
+    Source & source;
+    Sink & sink;
+    splice_pipe pipe{};
+    std::size_t pipe_size = 0u;
+    std::size_t in_pipe = 0u;
+    std::size_t completed = 0u;
+    bool source_done = false;
+    struct fallback_tag{};
+
+    template<typename Self>
+    void operator()(Self && self)
+    {
+        asio::error_code ec;
+        pipe_size = pipe.open(ec);
+        if (!ec)
+            source.native_non_blocking(true, ec);
+        if (!ec)
+            sink.native_non_blocking(true, ec);
+        // the first round may already finish the copy, so it must not run
+        // inside the initiating function
+        auto exec = self.get_executor();
+        asio::post(exec, asio::experimental::append(std::move(self), ec));
+    }
+
+    template<typename Self>
+    void operator()(Self && self, asio::error_code ec)
+    {
+        if (!ec && self.get_cancellation_state().cancelled() != asio::cancellation_type::none)
+            ec = asio::error::operation_aborted;
+        if (ec)
+            return self.complete(ec, completed);
+
+        for (int round = 0; round < max_rounds; round++)
+        {
+            bool progress = false;
+            if (!source_done && in_pipe < pipe_size)
+            {
+                auto n = ::splice(source.native_handle(), nullptr, pipe.write_end, nullptr,
+                                  pipe_size - in_pipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n > 0)
+                    in_pipe += std::size_t(n);
+                else if (n == 0)
+                    source_done = true;
+                else if (errno == EINVAL && completed == 0u && in_pipe == 0u)
+                    // this kind of socket cannot be spliced
+                    return fallback(std::move(self));
+                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    return self.complete(asio::error_code(errno, asio::error::get_system_category()),
+                                         completed);
+                progress = n >= 0;
+            }
+
+            if (in_pipe > 0u)
+            {
+                auto n = ::splice(pipe.read_end, nullptr, sink.native_handle(), nullptr,
+                                  in_pipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n > 0)
+                {
+                    in_pipe -= std::size_t(n);
+                    completed += std::size_t(n);
+                    progress = true;
+                }
+                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    return self.complete(asio::error_code(errno, asio::error::get_system_category()),
+                                         completed);
+            }
+
+            if (source_done && in_pipe == 0u)
+                return self.complete(asio::error::eof, completed);
+            if (!progress)
+                break;
+        }
+
+        // wait for whichever side is holding things up
+        if (in_pipe > 0u)
+            sink.async_wait(asio::socket_base::wait_write, std::move(self));
+        else
+            source.async_wait(asio::socket_base::wait_read, std::move(self));
+    }
+
+    template<typename Self>
+    void fallback(Self && self)
+    {
+        auto handler = asio::experimental::prepend(std::move(self), fallback_tag{});
+        asio::async_compose<decltype(handler), void(std::error_code, std::size_t)>(
+                buffered_copy_op<Source, Sink>{source, sink}, handler, source, sink);
+    }
+
+    template<typename Self>
+    void operator()(Self && self, fallback_tag, asio::error_code ec, std::size_t n)
+    {
+        self.complete(ec, n);
+    }
+};
+
+#endif
+
+}
+
+/// Copy everything that can be read from the stream `source` to the stream
+/// `sink`, until the end of the source or an error.
+///
+/// On Linux, when both are stream sockets, the data is moved with `splice(2)`
+/// through a pipe, so that it never gets copied into user space. Otherwise,
+/// or if the kernel refuses to splice the sockets, it is copied through a
+/// buffer with `async_read_some` and `async_write`.
+///
+/// Completes with the error that ended the copy, which is `error::eof` once
+/// the source has been drained, and the number of bytes written, like
+/// `async_copy`.
+template<typename Source, typename Sink, typename CompletionToken>
+auto async_splice_copy(Source & source, Sink & sink, CompletionToken && token)
+{
+#if defined(ASIOEX_HAS_SPLICE)
+    if constexpr (detail::is_splice_capable<Source, Sink>::value)
+        return asio::async_compose<CompletionToken, void(std::error_code, std::size_t)>(
+                detail::splice_copy_op<Source, Sink>{source, sink}, token, source, sink);
+    else
+#endif
+    return asio::async_compose<CompletionToken, void(std::error_code, std::size_t)>(
+            detail::buffered_copy_op<Source, Sink>{source, sink}, token, source, sink);
+}
+
+}
+
+#endif   // ASIO_EXPERIMENTS_SPLICE_COPY_HPP
@@ -0,0 +1,26 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIO_EXPERIMENTS_INCLUDE_ASIOEX_ST_ASYNC_SEMAPHORE_HPP
+#define ASIO_EXPERIMENTS_INCLUDE_ASIOEX_ST_ASYNC_SEMAPHORE_HPP
+
+#include <asioex/async_semaphore.hpp>
+
+namespace asioex::st
+{
+template < class Executor    = asio::any_io_executor,
+           class QueuePolicy = fifo_wait_queue,
+           class StatsPolicy = null_sync_stats >
+using basic_async_semaphore =
+    asioex::basic_async_semaphore< Executor, QueuePolicy, StatsPolicy >;
+
+using async_semaphore = asioex::async_semaphore;
+
+}   // namespace asioex::st
+#endif   // ASIO_EXPERIMENTS_INCLUDE_ASIOEX_ST_ASYNC_SEMAPHORE_HPP
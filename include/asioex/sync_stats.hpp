@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_SYNC_STATS_HPP
+#define ASIOEX_SYNC_STATS_HPP
+
+#include <asio/associator.hpp>
+#include <asio/error.hpp>
+#include <asioex/detail/predicate_handler.hpp>
+#include <asioex/error_code.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace asioex
+{
+/// @brief A histogram of wait times in log-linear buckets.
+/// @details Each power of two of nanoseconds is split into four equal
+/// buckets, so every bucket is within 25% of the values it counts, from 1ns
+/// up to about half an hour. Longer waits are counted in the last bucket.
+struct wait_time_histogram
+{
+    static constexpr std::size_t sub_bucket_bits = 2;
+    static constexpr std::size_t sub_buckets     = 1 << sub_bucket_bits;
+    static constexpr std::size_t magnitudes      = 40;
+    static constexpr std::size_t bucket_count    = magnitudes * sub_buckets;
+
+    /// @brief The bucket which counts a wait of ns nanoseconds.
+    static constexpr std::size_t
+    bucket_of(std::uint64_t ns) noexcept
+    {
+        if (ns < sub_buckets)
+            return static_cast< std::size_t >(ns);
+        auto msb = static_cast< std::size_t >(std::bit_width(ns)) - 1;
+        auto sub = static_cast< std::size_t >(ns >> (msb - sub_bucket_bits)) &
+                   (sub_buckets - 1);
+        auto i   = (msb - sub_bucket_bits + 1) * sub_buckets + sub;
+        return i < bucket_count ? i : bucket_count - 1;
+    }
+
+    /// @brief The shortest wait, in nanoseconds, counted by bucket i.
+    static constexpr std::uint64_t
+    lower_bound(std::size_t i) noexcept
+    {
+        if (i < sub_buckets)
+            return i;
+        auto msb = i / sub_buckets + sub_bucket_bits - 1;
+        auto sub = i % sub_buckets;
+        return std::uint64_t(sub_buckets + sub) << (msb - sub_bucket_bits);
+    }
+
+    /// @brief The total number of waits recorded.
+    std::uint64_t
+    total() const noexcept
+    {
+        std::uint64_t n = 0;
+        for (auto c : counts)
+            n += c;
+        return n;
+    }
+
+    /// @brief The lower bound of the bucket holding the wait at fraction p
+    /// of the distribution, or 0 if nothing was recorded.
+    /// @pre 0 <= p <= 1
+    std::uint64_t
+    percentile(double p) const noexcept
+    {
+        auto n = total();
+        if (n == 0)
+            return 0;
+        auto rank = static_cast< std::uint64_t >(p * double(n - 1));
+        for (std::size_t i = 0; i < bucket_count; ++i)
+        {
+            if (rank < counts[i])
+                return lower_bound(i);
+            rank -= counts[i];
+        }
+        return lower_bound(bucket_count - 1);
+    }
+
+    std::array< std::uint64_t, bucket_count > counts {};
+};
+
+/// @brief A copy of the counters of a synchronization primitive.
+struct sync_stats_snapshot
+{
+    /// Acquire, lock or wait operations initiated.
+    std::uint64_t acquires = 0;
+
+    /// Operations which completed without waiting.
+    std::uint64_t fast_path = 0;
+
+    /// Times an operation was queued to wait.
+    std::uint64_t parks = 0;
+
+    /// Waits which completed with error::operation_aborted.
+    std::uint64_t cancellations = 0;
+
+    /// Waits which completed with error::timed_out, and acquires which timed
+    /// out without waiting because their deadline had already passed.
+    std::uint64_t timeouts = 0;
+
+    /// The longest the wait queue has been.
+    std::size_t max_queue_depth = 0;
+
+    /// Time from queueing a wait to its completion handler running.
+    wait_time_histogram wait_time;
+};
+
+/// @brief The default statistics policy, which records nothing.
+/// @details Every hook is an empty inline function and completion handlers
+/// are not wrapped, so a primitive using this policy is the same code as
+/// one with no statistics support at all.
+struct null_sync_stats
+{
+    static constexpr bool enabled = false;
+
+    void
+    on_acquire() noexcept
+    {
+    }
+
+    void
+    on_fast_path() noexcept
+    {
+    }
+
+    template < class Handler >
+    Handler &&
+    on_park(std::size_t, Handler &&handler) noexcept
+    {
+        return std::forward< Handler >(handler);
+    }
+
+    void
+    on_park(std::size_t) noexcept
+    {
+    }
+
+    void
+    on_requeue(std::size_t) noexcept
+    {
+    }
+
+    void
+    on_wait(std::chrono::steady_clock::duration, error_code const &) noexcept
+    {
+    }
+
+    void
+    on_timeout() noexcept
+    {
+    }
+
+    sync_stats_snapshot
+    snapshot() const noexcept
+    {
+        return {};
+    }
+};
+
+namespace detail
+{
+/// @brief The counters of a sync_stats policy.
+/// @details Waits are recorded by completion handlers, which may outlive the
+/// primitive and run on other threads, so the state is shared and atomic.
+struct sync_stats_state
+{
+    void
+    record_wait(std::chrono::steady_clock::duration waited,
+                error_code const                   &ec) noexcept
+    {
+        if (ec == asio::error::operation_aborted)
+            cancellations.fetch_add(1, std::memory_order_relaxed);
+        else if (ec == asio::error::timed_out)
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+
+        auto ns =
+            std::chrono::duration_cast< std::chrono::nanoseconds >(waited)
+                .count();
+        wait_time[wait_time_histogram::bucket_of(
+                      ns < 0 ? 0 : static_cast< std::uint64_t >(ns))]
+            .fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic< std::uint64_t > acquires {0};
+    std::atomic< std::uint64_t > fast_path {0};
+    std::atomic< std::uint64_t > parks {0};
+    std::atomic< std::uint64_t > cancellations {0};
+    std::atomic< std::uint64_t > timeouts {0};
+    std::atomic< std::size_t >   max_queue_depth {0};
+    std::array< std::atomic< std::uint64_t >,
+                wait_time_histogram::bucket_count >
+        wait_time {};
+};
+
+/// @brief A completion handler which records how long its waiter waited.
+template < class Handler >
+struct sync_stats_handler
+{
+    template < class H >
+    sync_stats_handler(std::shared_ptr< sync_stats_state > state, H &&h)
+    : state_(std::move(state))
+    , start_(std::chrono::steady_clock::now())
+    , handler_(std::forward< H >(h))
+    {
+    }
+
+    template < class... Args >
+    void
+    operator()(error_code ec, Args &&...args)
+    {
+        state_->record_wait(std::chrono::steady_clock::now() - start_, ec);
+        std::move(handler_)(ec, std::forward< Args >(args)...);
+    }
+
+    std::shared_ptr< sync_stats_state >   state_;
+    std::chrono::steady_clock::time_point start_;
+    Handler                               handler_;
+};
+
+template < class Handler >
+bool
+wait_ready(sync_stats_handler< Handler > &h)
+{
+    return wait_ready(h.handler_);
+}
+
+}   // namespace detail
+
+/// @brief A statistics policy which counts acquires, fast path hits, parks,
+/// cancellations, timeouts and the maximum queue depth, and keeps a
+/// histogram of wait times.
+/// @details Counting costs a relaxed atomic increment per event. Each parked
+/// wait additionally carries a shared reference to the counters and reads
+/// the clock twice.
+struct sync_stats
+{
+    static constexpr bool enabled = true;
+
+    sync_stats()
+    : state_(std::make_shared< detail::sync_stats_state >())
+    {
+    }
+
+    void
+    on_acquire() noexcept
+    {
+        state_->acquires.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void
+    on_fast_path() noexcept
+    {
+        state_->fast_path.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief Record a wait which is about to be queued behind depth - 1
+    /// others, and return its handler adapted to record the wait time.
+    template < class Handler >
+    detail::sync_stats_handler< std::decay_t< Handler > >
+    on_park(std::size_t depth, Handler &&handler)
+    {
+        on_park(depth);
+        return detail::sync_stats_handler< std::decay_t< Handler > >(
+            state_, std::forward< Handler >(handler));
+    }
+
+    /// @brief Record a wait which is about to be queued behind depth - 1
+    /// others, for a primitive which times the wait itself with on_wait.
+    void
+    on_park(std::size_t depth) noexcept
+    {
+        state_->parks.fetch_add(1, std::memory_order_relaxed);
+        on_requeue(depth);
+    }
+
+    /// @brief Record that a woken waiter which could not take the primitive
+    /// is queued again behind depth - 1 others. This continues the same wait,
+    /// so it is not counted as a park.
+    void
+    on_requeue(std::size_t depth) noexcept
+    {
+        // only the primitive's own thread parks, so this needs no CAS
+        if (depth > state_->max_queue_depth.load(std::memory_order_relaxed))
+            state_->max_queue_depth.store(depth, std::memory_order_relaxed);
+    }
+
+    /// @brief Record the end of a wait begun with on_park(depth).
+    void
+    on_wait(std::chrono::steady_clock::duration waited,
+            error_code const                   &ec) noexcept
+    {
+        state_->record_wait(waited, ec);
+    }
+
+    /// @brief Record an acquire which timed out without waiting.
+    void
+    on_timeout() noexcept
+    {
+        state_->timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    sync_stats_snapshot
+    snapshot() const noexcept
+    {
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        sync_stats_snapshot s;
+        s.acquires        = state_->acquires.load(relaxed);
+        s.fast_path       = state_->fast_path.load(relaxed);
+        s.parks           = state_->parks.load(relaxed);
+        s.cancellations   = state_->cancellations.load(relaxed);
+        s.timeouts        = state_->timeouts.load(relaxed);
+        s.max_queue_depth = state_->max_queue_depth.load(relaxed);
+        for (std::size_t i = 0; i < wait_time_histogram::bucket_count; ++i)
+            s.wait_time.counts[i] = state_->wait_time[i].load(relaxed);
+        return s;
+    }
+
+  private:
+    std::shared_ptr< detail::sync_stats_state > state_;
+};
+
+}   // namespace asioex
+
+namespace asio
+{
+template < template < typename, typename > class Associator,
+           typename Handler,
+           typename DefaultCandidate >
+struct associator< Associator,
+                   asioex::detail::sync_stats_handler< Handler >,
+                   DefaultCandidate > : Associator< Handler, DefaultCandidate >
+{
+    static typename Associator< Handler, DefaultCandidate >::type
+    get(const asioex::detail::sync_stats_handler< Handler > &h,
+        const DefaultCandidate &c = DefaultCandidate()) ASIO_NOEXCEPT
+    {
+        return Associator< Handler, DefaultCandidate >::get(h.handler_, c);
+    }
+};
+}   // namespace asio
+
+#endif
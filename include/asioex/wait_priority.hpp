@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_WAIT_PRIORITY_HPP
+#define ASIOEX_WAIT_PRIORITY_HPP
+
+#include <asio/associator.hpp>
+#include <asio/async_result.hpp>
+#include <asioex/associated_immediacy.hpp>
+#include <asioex/detail/adapter_access.hpp>
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace asioex
+{
+
+/// The rank of a queued wait. Lower values are served first, so a deadline
+/// expressed as a time point count can be used directly.
+using wait_priority = std::int64_t;
+
+/// Trait which yields the wait_priority associated with a handler.
+/// Handlers with a `get_wait_priority()` member use it, all others rank 0.
+template <typename T, typename = void>
+struct associated_wait_priority
+{
+    static wait_priority get(const T &) noexcept { return 0; }
+};
+
+template <typename T>
+struct associated_wait_priority<
+    T, std::void_t<decltype(std::declval<const T &>().get_wait_priority())>>
+{
+    static wait_priority get(const T & t) noexcept
+    {
+        return t.get_wait_priority();
+    }
+};
+
+template <typename T>
+inline wait_priority get_associated_wait_priority(const T & t) noexcept
+{
+    return associated_wait_priority<T>::get(t);
+}
+
+/// A completion token adapter which associates a wait_priority with the
+/// completion handler.
+template <typename CompletionToken>
+class wait_priority_t
+{
+  public:
+    /// Constructor.
+    template <typename T>
+    wait_priority_t(wait_priority priority, ASIO_MOVE_ARG(T) completion_token)
+        : priority_(priority), token_(ASIO_MOVE_CAST(T)(completion_token))
+    {
+    }
+
+  private:
+    friend struct detail::adapter_access;
+
+    wait_priority priority_;
+    CompletionToken token_;
+};
+
+/// Adapt a @ref completion_token to carry a wait_priority.
+template <typename CompletionToken>
+inline wait_priority_t<typename std::decay<CompletionToken>::type>
+bind_wait_priority(wait_priority priority,
+                   ASIO_MOVE_ARG(CompletionToken) completion_token)
+{
+    return wait_priority_t<typename std::decay<CompletionToken>::type>(
+        priority, ASIO_MOVE_CAST(CompletionToken)(completion_token));
+}
+
+namespace detail {
+
+// Class to adapt a wait_priority_t as a completion handler.
+template <typename Handler>
+class wait_priority_handler
+{
+  public:
+    typedef void result_type;
+
+    template <typename RedirectedHandler>
+    wait_priority_handler(wait_priority priority,
+                          ASIO_MOVE_ARG(RedirectedHandler) h)
+    : priority_(priority), handler_(ASIO_MOVE_CAST(RedirectedHandler)(h))
+    {
+    }
+
+    template <typename... Args>
+    void operator()(ASIO_MOVE_ARG(Args)... args)
+    {
+        ASIO_MOVE_OR_LVALUE(Handler)(handler_)(ASIO_MOVE_CAST(Args)(args)...);
+    }
+
+    wait_priority get_wait_priority() const noexcept
+    {
+        return priority_;
+    }
+
+    bool get_immediacy() const noexcept
+    {
+        return get_associated_immediacy(handler_);
+    }
+
+  private:
+    friend struct detail::adapter_access;
+
+    wait_priority priority_;
+    Handler handler_;
+};
+
+} // namespace detail
+}
+
+namespace asio {
+
+#if !defined(GENERATING_DOCUMENTATION)
+
+template <typename CompletionToken, typename Signature>
+struct async_result<asioex::wait_priority_t<CompletionToken>, Signature>
+{
+    typedef typename async_result<CompletionToken, Signature>
+        ::return_type return_type;
+
+    template <typename Initiation>
+    struct init_wrapper
+    {
+        template <typename Init>
+        init_wrapper(asioex::wait_priority priority, ASIO_MOVE_ARG(Init) init)
+        : priority_(priority), initiation_(ASIO_MOVE_CAST(Init)(init))
+        {
+        }
+
+        template <typename Handler, typename... Args>
+        void operator()(
+            ASIO_MOVE_ARG(Handler) handler,
+            ASIO_MOVE_ARG(Args)... args)
+        {
+            ASIO_MOVE_CAST(Initiation)(initiation_)(
+                asioex::detail::wait_priority_handler<
+                    typename decay<Handler>::type>(
+                    priority_, ASIO_MOVE_CAST(Handler)(handler)),
+                ASIO_MOVE_CAST(Args)(args)...);
+        }
+
+        asioex::wait_priority priority_;
+        Initiation initiation_;
+    };
+
+    template <typename Initiation, typename RawCompletionToken, typename... Args>
+    static return_type initiate(
+        ASIO_MOVE_ARG(Initiation) initiation,
+        ASIO_MOVE_ARG(RawCompletionToken) token,
+        ASIO_MOVE_ARG(Args)... args)
+    {
+        return async_initiate<CompletionToken, Signature>(
+            init_wrapper<typename decay<Initiation>::type>(
+                asioex::detail::adapter_access::priority(token),
+                ASIO_MOVE_CAST(Initiation)(initiation)),
+            asioex::detail::adapter_access::token(token),
+            ASIO_MOVE_CAST(Args)(args)...);
+    }
+};
+
+template <template <typename, typename> class Associator,
+           typename Handler, typename DefaultCandidate>
+struct associator<Associator,
+                   asioex::detail::wait_priority_handler<Handler>, DefaultCandidate>
+: Associator<Handler, DefaultCandidate>
+{
+    static typename Associator<Handler, DefaultCandidate>::type get(
+        const asioex::detail::wait_priority_handler<Handler>& h,
+        const DefaultCandidate& c = DefaultCandidate()) ASIO_NOEXCEPT
+    {
+        return Associator<Handler, DefaultCandidate>::get(
+            asioex::detail::adapter_access::handler(h), c);
+    }
+};
+
+#endif // !defined(GENERATING_DOCUMENTATION)
+
+} // namespace asio
+
+#endif   // ASIOEX_WAIT_PRIORITY_HPP
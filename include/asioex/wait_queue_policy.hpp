@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_WAIT_QUEUE_POLICY_HPP
+#define ASIOEX_WAIT_QUEUE_POLICY_HPP
+
+#include <asioex/detail/sized_bilist.hpp>
+#include <asioex/wait_priority.hpp>
+
+namespace asioex
+{
+/// @brief Waiters are served in the order they arrived.
+struct fifo_wait_queue
+{
+    template < class Op >
+    static void
+    enqueue(detail::sized_bilist &waiters, Op *op)
+    {
+        waiters.push_back(op);
+    }
+};
+
+/// @brief The most recent waiter is served first.
+/// @details Under sustained overload this keeps the latency of the requests
+/// which are served low, at the cost of starving the oldest ones.
+struct lifo_wait_queue
+{
+    template < class Op >
+    static void
+    enqueue(detail::sized_bilist &waiters, Op *op)
+    {
+        waiters.push_front(op);
+    }
+};
+
+/// @brief Waiters are served in ascending order of the wait_priority
+/// associated with their completion handler, and in arrival order among
+/// equals.
+/// @details Insertion scans from the least urgent end of the queue, so it is
+/// constant time when priorities arrive in order, as deadlines usually do.
+/// @see bind_wait_priority
+struct priority_wait_queue
+{
+    template < class Op >
+    static void
+    enqueue(detail::sized_bilist &waiters, Op *op)
+    {
+        waiters.insert_before_trailing(
+            op,
+            [op](detail::bilist_node *n)
+            { return static_cast< Op * >(n)->priority_ > op->priority_; });
+    }
+};
+
+}   // namespace asioex
+
+#endif
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#ifndef ASIOEX_WEIGHT_HPP
+#define ASIOEX_WEIGHT_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace asioex
+{
+/// @brief Weighs every item as one unit, so that a capacity or a limit is a
+/// number of items.
+struct unit_weight
+{
+    template < class T >
+    std::size_t
+    operator()(T const &) const noexcept
+    {
+        return 1;
+    }
+};
+
+/// @brief Weighs an item holding a contiguous range by the number of bytes
+/// in the range, so that a capacity or a limit is a number of bytes.
+struct byte_weight
+{
+    template < class T >
+    std::size_t
+    operator()(T const &t) const noexcept
+    {
+        return std::size(t) * sizeof(*std::data(t));
+    }
+};
+
+}   // namespace asioex
+
+#endif
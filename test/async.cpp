@@ -13,8 +13,11 @@
 #include <asio/error.hpp>
 #include <asio/recycling_allocator.hpp>
 #include <asio/steady_timer.hpp>
+#include <asio/use_awaitable.hpp>
 #include <asio/use_future.hpp>
 #include <asioex/async.hpp>
+#include <asioex/async_semaphore.hpp>
+#include <asioex/immediate.hpp>
 
 #include <boost/scope_exit.hpp>
 
@@ -193,6 +196,47 @@ TEST_CASE("single op benchmark")
     }
 }
 
+template<typename CompletionToken>
+asio::awaitable<void> acquire_loop(asioex::async_semaphore &sem,
+                                   CompletionToken token)
+{
+    for (std::size_t idx = 0u; idx < 1000000u; idx++)
+    {
+        co_await sem.async_acquire(token);
+        sem.release();
+    }
+}
+
+TEST_CASE("uncontended acquire benchmark")
+{
+    using clock = std::chrono::steady_clock;
+    SUBCASE("posted acquire")
+    {
+        asio::io_context ctx;
+        asioex::async_semaphore sem{ctx.get_executor()};
+        asio::co_spawn(ctx, acquire_loop(sem, asio::use_awaitable), asio::detached);
+        auto start = clock::now();
+        ctx.run();
+        auto end = clock::now();
+
+        std::printf("Posted    acquire took %lldns\n", std::chrono::nanoseconds(end - start).count());
+    }
+
+    SUBCASE("immediate acquire")
+    {
+        asio::io_context ctx;
+        asioex::async_semaphore sem{ctx.get_executor()};
+        asio::co_spawn(ctx,
+                       acquire_loop(sem, asioex::immediate(asio::use_awaitable)),
+                       asio::detached);
+        auto start = clock::now();
+        ctx.run();
+        auto end = clock::now();
+
+        std::printf("Immediate acquire took %lldns\n", std::chrono::nanoseconds(end - start).count());
+    }
+}
+
 asio::awaitable<void> awaitable_impl()
 try
 {
@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asio.hpp>
+
+#include <asioex/async_barrier.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace asioex;
+
+#define check_eq(X, Y)                                                         \
+    if ((X) != (Y))                                                            \
+    {                                                                          \
+        printf(#X " == " #Y " failed: %lld != %lld\n",                         \
+               static_cast< long long >(X),                                    \
+               static_cast< long long >(Y));                                   \
+        errors++;                                                              \
+    }
+
+using executor = asio::io_context::executor_type;
+
+struct count_phases
+{
+    void
+    operator()() noexcept
+    {
+        log->push_back(-1);
+    }
+
+    std::vector< int > *log;
+};
+
+int
+test_phases()
+{
+    int errors = 0;
+
+    asio::io_context                                  ioc;
+    std::vector< int >                                log;
+    basic_async_barrier< executor, count_phases > barrier {
+        ioc.get_executor(), 3, count_phases { &log }
+    };
+
+    // each participant records its id when it resumes, then arrives again
+    std::function< void(int, int) > participate = [&](int id, int rounds)
+    {
+        barrier.async_arrive_and_wait(
+            [&, id, rounds](error_code ec)
+            {
+                if (ec)
+                    return;
+                log.push_back(id);
+                if (rounds > 1)
+                    participate(id, rounds - 1);
+            });
+    };
+    for (int id = 0; id < 3; ++id)
+        participate(id, 2);
+    ioc.run();
+
+    check_eq(barrier.phase(), 2);
+    check_eq(barrier.pending(), 3);
+
+    // the completion function runs before anybody resumes
+    check_eq(log.size(), 8);
+    check_eq(log[0], -1);
+    check_eq(log[4], -1);
+    int resumed = 0;
+    for (auto i : log)
+        resumed += i >= 0;
+    check_eq(resumed, 6);
+
+    return errors;
+}
+
+int
+test_drop()
+{
+    int errors = 0;
+
+    asio::io_context          ioc;
+    basic_async_barrier< executor > barrier { ioc.get_executor(), 3 };
+
+    int done = 0;
+    barrier.async_arrive_and_wait([&](error_code ec) { done += !ec; });
+    barrier.arrive_and_drop();
+    check_eq(barrier.phase(), 0);
+    barrier.arrive();
+    ioc.run();
+    check_eq(done, 1);
+    check_eq(barrier.phase(), 1);
+    check_eq(barrier.expected(), 2);
+
+    barrier.async_arrive_and_wait([&](error_code ec) { done += !ec; });
+    barrier.async_arrive_and_wait([&](error_code ec) { done += !ec; });
+    ioc.restart();
+    ioc.run();
+    check_eq(done, 3);
+    check_eq(barrier.phase(), 2);
+
+    return errors;
+}
+
+int
+test_cancel()
+{
+    int errors = 0;
+
+    asio::io_context                ioc;
+    asio::cancellation_signal       sig;
+    basic_async_barrier< executor > barrier { ioc.get_executor(), 2 };
+
+    error_code ec1;
+    barrier.async_arrive_and_wait(
+        asio::bind_cancellation_slot(sig.slot(),
+                                     [&](error_code ec) { ec1 = ec; }));
+    sig.emit(asio::cancellation_type::terminal);
+    ioc.run();
+    check_eq(ec1 == asio::error::operation_aborted, true);
+
+    // the cancelled arrival still counts
+    check_eq(barrier.pending(), 1);
+    barrier.arrive();
+    check_eq(barrier.phase(), 1);
+
+    return errors;
+}
+
+int
+main()
+{
+    int res = 0;
+    res += test_phases();
+    res += test_drop();
+    res += test_cancel();
+    return res;
+}
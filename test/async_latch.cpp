@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asio.hpp>
+
+#include <asioex/async_latch.hpp>
+#include <asioex/async_semaphore.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace asioex;
+
+#define check_eq(X, Y)                                                         \
+    if ((X) != (Y))                                                            \
+    {                                                                          \
+        printf(#X " == " #Y " failed: %lld != %lld\n",                         \
+               static_cast< long long >(X),                                    \
+               static_cast< long long >(Y));                                   \
+        errors++;                                                              \
+    }
+
+using executor = asio::io_context::executor_type;
+
+int
+test_count_down()
+{
+    int errors = 0;
+
+    asio::io_context            ioc;
+    basic_async_latch< executor > latch { ioc.get_executor(), 3 };
+
+    int done = 0;
+    latch.async_wait([&](error_code ec) { done += !ec; });
+    latch.async_wait([&](error_code ec) { done += !ec; });
+    check_eq(latch.try_wait(), false);
+
+    // the parked waits keep the context busy, so poll rather than run
+    latch.count_down();
+    latch.count_down();
+    ioc.poll();
+    check_eq(done, 0);
+    check_eq(latch.value(), 1);
+
+    latch.count_down();
+    ioc.restart();
+    ioc.run();
+    check_eq(done, 2);
+    check_eq(latch.try_wait(), true);
+
+    // once open the latch stays open
+    latch.async_wait([&](error_code ec) { done += !ec; });
+    ioc.restart();
+    ioc.run();
+    check_eq(done, 3);
+
+    return errors;
+}
+
+int
+test_cancel()
+{
+    int errors = 0;
+
+    asio::io_context          ioc;
+    asio::cancellation_signal sig;
+    int                       aborted = 0;
+    {
+        basic_async_latch< executor > latch { ioc.get_executor(), 1 };
+        latch.async_wait(asio::bind_cancellation_slot(
+            sig.slot(),
+            [&](error_code ec)
+            { aborted += ec == asio::error::operation_aborted; }));
+        latch.async_wait(
+            [&](error_code ec)
+            { aborted += ec == asio::error::operation_aborted; });
+
+        // the second wait is still parked
+        sig.emit(asio::cancellation_type::terminal);
+        ioc.poll();
+        check_eq(aborted, 1);
+    }
+    ioc.restart();
+    ioc.run();
+    check_eq(aborted, 2);
+
+    return errors;
+}
+
+// A parent joins children which each finish in their own posted work item.
+void
+benchmark_join()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int children = 1000;
+    constexpr int rounds   = 200;
+
+    auto run = [&](auto join, const char *name)
+    {
+        asio::io_context ioc;
+        auto             start = clock::now();
+        for (int r = 0; r < rounds; ++r)
+            join(ioc);
+        auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+        std::printf("%s join: %lldns per child\n",
+                    name,
+                    static_cast< long long >(ns / (children * rounds)));
+    };
+
+    run(
+        [](asio::io_context &ioc)
+        {
+            basic_async_semaphore< executor > sem { ioc.get_executor(), 0 };
+            for (int i = 0; i < children; ++i)
+                asio::post(ioc, [&sem] { sem.release(); });
+
+            // the parent waits once per child
+            int  joined = 0;
+            auto next   = [&](auto &self) -> void
+            {
+                sem.async_acquire(
+                    [&, self](error_code)
+                    {
+                        if (++joined < children)
+                            self(self);
+                    });
+            };
+            next(next);
+            ioc.restart();
+            ioc.run();
+        },
+        "semaphore");
+
+    run(
+        [](asio::io_context &ioc)
+        {
+            basic_async_latch< executor > latch { ioc.get_executor(),
+                                                  children };
+            for (int i = 0; i < children; ++i)
+                asio::post(ioc, [&latch] { latch.count_down(); });
+            latch.async_wait([](error_code) {});
+            ioc.restart();
+            ioc.run();
+        },
+        "    latch");
+}
+
+int
+main()
+{
+    int res = 0;
+    res += test_count_down();
+    res += test_cancel();
+    benchmark_join();
+    return res;
+}
@@ -0,0 +1,349 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asio.hpp>
+#include <asio/experimental/channel.hpp>
+
+#include <asioex/async_queue.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace asioex;
+
+#define check_eq(X, Y)                                                         \
+    if ((X) != (Y))                                                            \
+    {                                                                          \
+        printf(#X " == " #Y " failed: %lld != %lld\n",                         \
+               static_cast< long long >(X),                                    \
+               static_cast< long long >(Y));                                   \
+        errors++;                                                              \
+    }
+
+using executor   = asio::io_context::executor_type;
+using queue_type = basic_async_queue< int, executor >;
+
+int
+test_try()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 2 };
+
+    check_eq(q.try_push(1), true);
+    check_eq(q.try_push(2), true);
+    check_eq(q.try_push(3), false);
+    check_eq(q.size(), 2);
+    check_eq(q.used(), 2);
+
+    int value = 0;
+    check_eq(q.try_pop(value), true);
+    check_eq(value, 1);
+    check_eq(q.try_pop(value), true);
+    check_eq(value, 2);
+    check_eq(q.try_pop(value), false);
+    check_eq(q.used(), 0);
+
+    // nothing was posted
+    check_eq(ioc.poll(), 0);
+
+    return errors;
+}
+
+int
+test_backpressure()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 1 };
+
+    int pushed = 0;
+    for (int i = 0; i < 4; ++i)
+        q.async_push(i, [&](error_code ec) { pushed += !ec; });
+    // the three pushes still waiting keep the context busy
+    ioc.poll();
+    check_eq(pushed, 1);
+    check_eq(q.size(), 1);
+
+    // a waiting push is not overtaken
+    q.async_pop([](error_code, int) {});
+    check_eq(q.try_push(9), false);
+
+    std::vector< int > popped;
+    for (int i = 0; i < 3; ++i)
+        q.async_pop([&](error_code ec, int v)
+                    { if (!ec) popped.push_back(v); });
+    ioc.restart();
+    ioc.run();
+    check_eq(pushed, 4);
+    check_eq(popped.size(), 3);
+    for (std::size_t i = 0; i < popped.size(); ++i)
+        check_eq(popped[i], int(i) + 1);
+    check_eq(q.size(), 0);
+
+    return errors;
+}
+
+int
+test_byte_weight()
+{
+    int errors = 0;
+
+    asio::io_context                                         ioc;
+    basic_async_queue< std::string, executor, byte_weight > q {
+        ioc.get_executor(), 8
+    };
+
+    check_eq(q.try_push("hello"), true);
+    check_eq(q.try_push("abc"), true);
+    check_eq(q.used(), 8);
+
+    bool pushed = false;
+    q.async_push("x", [&](error_code ec) { pushed = !ec; });
+    ioc.poll();
+    check_eq(pushed, false);
+
+    std::string s;
+    check_eq(q.try_pop(s), true);
+    check_eq(s.size(), 5);
+    ioc.restart();
+    ioc.run();
+    check_eq(pushed, true);
+    check_eq(q.used(), 4);
+
+    // an item heavier than the capacity still fits an empty queue
+    q.try_pop(s);
+    q.try_pop(s);
+    check_eq(q.try_push(std::string(20, 'z')), true);
+    check_eq(q.used(), 8);
+
+    return errors;
+}
+
+int
+test_close()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 1 };
+
+    q.try_push(1);
+    error_code push_ec;
+    q.async_push(2, [&](error_code ec) { push_ec = ec; });
+    q.close();
+    check_eq(q.is_open(), false);
+    ioc.run();
+    check_eq(push_ec == asio::error::broken_pipe, true);
+
+    // queued items are still delivered
+    error_code pop_ec;
+    int        value = 0;
+    q.async_pop(
+        [&](error_code ec, int v)
+        {
+            pop_ec = ec;
+            value  = v;
+        });
+    ioc.restart();
+    ioc.run();
+    check_eq(!pop_ec, true);
+    check_eq(value, 1);
+
+    q.async_pop([&](error_code ec, int) { pop_ec = ec; });
+    ioc.restart();
+    ioc.run();
+    check_eq(pop_ec == asio::error::eof, true);
+
+    return errors;
+}
+
+int
+test_cancel()
+{
+    int errors = 0;
+
+    asio::io_context          ioc;
+    asio::cancellation_signal sig;
+    queue_type                q { ioc.get_executor(), 1 };
+
+    error_code ec1;
+    q.async_pop(asio::bind_cancellation_slot(
+        sig.slot(), [&](error_code ec, int) { ec1 = ec; }));
+    sig.emit(asio::cancellation_type::terminal);
+    ioc.run();
+    check_eq(ec1 == asio::error::operation_aborted, true);
+
+    // the cancelled pop did not take the next item
+    q.try_push(7);
+    int value = 0;
+    check_eq(q.try_pop(value), true);
+    check_eq(value, 7);
+
+    return errors;
+}
+
+int
+test_pop_some()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 8 };
+
+    for (int i = 0; i < 5; ++i)
+        q.try_push(int(i));
+
+    std::array< int, 3 > out {};
+    std::size_t          got = 0;
+    q.async_pop_some(out, [&](error_code, std::size_t n) { got = n; });
+    ioc.run();
+    check_eq(got, 3);
+    check_eq(out[2], 2);
+    check_eq(q.try_pop_some(out), 2);
+    check_eq(out[1], 4);
+
+    // a waiting batch pop takes what is there when it resumes
+    got = 0;
+    q.async_pop_some(out, [&](error_code, std::size_t n) { got = n; });
+    q.try_push(10);
+    q.try_push(11);
+    ioc.restart();
+    ioc.run();
+    check_eq(got, 1);
+    check_eq(out[0], 10);
+    check_eq(q.size(), 1);
+
+    return errors;
+}
+
+using channel_type =
+    asio::experimental::channel< void(asio::error_code, int) >;
+
+template < class H >
+void
+send(queue_type &q, int v, H &&h)
+{
+    q.async_push(v, std::forward< H >(h));
+}
+
+template < class H >
+void
+send(channel_type &c, int v, H &&h)
+{
+    c.async_send(error_code(), v, std::forward< H >(h));
+}
+
+template < class H >
+void
+receive(queue_type &q, H &&h)
+{
+    q.async_pop(std::forward< H >(h));
+}
+
+template < class H >
+void
+receive(channel_type &c, H &&h)
+{
+    c.async_receive(std::forward< H >(h));
+}
+
+template < class Queue >
+struct producer
+{
+    void
+    operator()(error_code ec = {})
+    {
+        if (!ec && left-- > 0)
+            send(*q, left, std::move(*this));
+    }
+
+    Queue *q;
+    int    left;
+};
+
+template < class Queue >
+struct consumer
+{
+    void
+    operator()(error_code ec, int)
+    {
+        if (ec)
+            return;
+        if (++*received == total)
+            q->close();
+        else
+            receive(*q, std::move(*this));
+    }
+
+    Queue *q;
+    int   *received;
+    int    total;
+};
+
+void
+benchmark_throughput()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int         items    = 1'000'000;
+    constexpr std::size_t capacity = 64;
+
+    auto run = [&](auto &q, asio::io_context &ioc, int n, const char *name)
+    {
+        using queue = std::decay_t< decltype(q) >;
+        int  received = 0;
+        auto start    = clock::now();
+        for (int i = 0; i < n; ++i)
+        {
+            producer< queue > { &q, items / n }();
+            receive(q, consumer< queue > { &q, &received, items });
+        }
+        ioc.run();
+        auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+        std::printf("%s %dP%dC: %lldns per item\n",
+                    name,
+                    n,
+                    n,
+                    static_cast< long long >(ns / items));
+    };
+
+    for (int n : { 1, 4 })
+    {
+        {
+            asio::io_context ioc;
+            queue_type       q { ioc.get_executor(), capacity };
+            run(q, ioc, n, "  queue");
+        }
+        {
+            asio::io_context ioc;
+            channel_type     c { ioc.get_executor(), capacity };
+            run(c, ioc, n, "channel");
+        }
+    }
+}
+
+int
+main()
+{
+    int res = 0;
+    res += test_try();
+    res += test_backpressure();
+    res += test_byte_weight();
+    res += test_close();
+    res += test_cancel();
+    res += test_pop_some();
+    benchmark_throughput();
+    return res;
+}
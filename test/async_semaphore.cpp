@@ -13,9 +13,12 @@
 #include <asio/experimental/as_tuple.hpp>
 #include <asio/experimental/awaitable_operators.hpp>
 #include <asioex/async_semaphore.hpp>
+#include <asioex/immediate.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <random>
+#include <vector>
 
 namespace asioex
 {
@@ -119,14 +122,383 @@ int test_value()
     sem.async_acquire(asio::detached);
     check_eq(sem.value(), -2);
 
+    sem.release();
+    check_eq(sem.value(), -1);
+
+    check_eq(static_cast< int >(sem.release_all()), 1);
+    check_eq(sem.value(), 0);
+
     return errors;
 }
 
+int test_weighted()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    async_semaphore sem{ioc.get_executor(), 0};
+
+    std::vector< int > order;
+    sem.async_acquire(3, [&](error_code) { order.push_back(3); });
+    sem.async_acquire(1, [&](error_code) { order.push_back(1); });
+    check_eq(sem.value(), -4);
+
+    // the head of the queue wants 3, so 2 must not let the 1 overtake it
+    sem.release(2);
+    check_eq(sem.try_acquire(), false);
+    // the parked acquires keep the context busy, so run() would not return
+    ioc.poll();
+    check_eq(static_cast< int >(order.size()), 0);
+
+    sem.release(2);
+    ioc.restart();
+    ioc.run();
+    check_eq(static_cast< int >(order.size()), 2);
+    check_eq(order[0], 3);
+    check_eq(order[1], 1);
+    check_eq(sem.value(), 0);
+
+    return errors;
+}
+
+int test_pool()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    async_semaphore sem{ioc.get_executor(), 0};
+
+    // the second round of waiters reuses the blocks freed by the first
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = 0; i < 8; ++i)
+            sem.async_acquire(asio::detached);
+        sem.release(8);
+        ioc.restart();
+        ioc.run();
+    }
+
+    auto stats = sem.pool_stats();
+    check_eq(static_cast< int >(stats.hits + stats.misses), 16);
+    check_eq(stats.hits >= 8u, true);
+
+    return errors;
+}
+
+template < class QueuePolicy >
+std::vector< int >
+served_order(std::vector< wait_priority > const &priorities)
+{
+    asio::io_context ioc;
+    basic_async_semaphore< asio::io_context::executor_type, QueuePolicy > sem {
+        ioc.get_executor(), 0
+    };
+
+    std::vector< int > order;
+    for (int i = 0; i < static_cast< int >(priorities.size()); ++i)
+        sem.async_acquire(bind_wait_priority(
+            priorities[i], [&order, i](error_code) { order.push_back(i); }));
+
+    // one at a time, so that each completion reflects the queue head. The
+    // waiters still parked keep the context busy, so poll rather than run.
+    for (std::size_t i = 0; i < priorities.size(); ++i)
+    {
+        sem.release();
+        ioc.poll();
+    }
+    return order;
+}
+
+int test_queue_policy()
+{
+    int errors = 0;
+
+    check_eq(served_order< fifo_wait_queue >({ 3, 1, 2 }) ==
+                 std::vector< int >({ 0, 1, 2 }),
+             true);
+    check_eq(served_order< lifo_wait_queue >({ 3, 1, 2 }) ==
+                 std::vector< int >({ 2, 1, 0 }),
+             true);
+    // equal priorities keep their arrival order
+    check_eq(served_order< priority_wait_queue >({ 3, 1, 2, 1 }) ==
+                 std::vector< int >({ 1, 3, 2, 0 }),
+             true);
+
+    return errors;
+}
+
+// The priority and inline completion each survive being wrapped in the other
+// adapter, whichever way round they are applied.
+int test_combined_adapters()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    basic_async_semaphore< asio::io_context::executor_type,
+                           priority_wait_queue >
+        sem { ioc.get_executor(), 0 };
+
+    std::vector< int > order;
+    sem.async_acquire(asioex::immediate(bind_wait_priority(
+        2, [&order](error_code) { order.push_back(0); })));
+    sem.async_acquire(bind_wait_priority(
+        1, asioex::immediate([&order](error_code) { order.push_back(1); })));
+    sem.release();
+    ioc.poll();
+    sem.release();
+    ioc.poll();
+    check_eq(order == std::vector< int >({ 1, 0 }), true);
+
+    // from inside the context both complete before async_acquire returns
+    sem.release(2);
+    bool first = false, second = false;
+    asio::post(ioc,
+               [&]
+               {
+                   sem.async_acquire(asioex::immediate(bind_wait_priority(
+                       1, [&first](error_code) { first = true; })));
+                   check_eq(first, true);
+                   sem.async_acquire(bind_wait_priority(
+                       1,
+                       asioex::immediate(
+                           [&second](error_code) { second = true; })));
+                   check_eq(second, true);
+               });
+    ioc.restart();
+    ioc.run();
+    check_eq(first && second, true);
+
+    return errors;
+}
+
+int test_deadline()
+{
+    int errors = 0;
+
+    asio::io_context ioc;
+    async_semaphore sem{ioc.get_executor(), 0};
+
+    auto       now = std::chrono::steady_clock::now();
+    error_code ec_a, ec_b, ec_c;
+    int        done = 0;
+    sem.async_acquire_until(now + 20ms, [&](error_code ec) { ec_a = ec; ++done; });
+    sem.async_acquire_until(now + 1h, [&](error_code ec) { ec_b = ec; ++done; });
+    sem.async_acquire_until(now + 5ms, [&](error_code ec) { ec_c = ec; ++done; });
+    check_eq(sem.value(), -3);
+
+    // the internal timer is armed for the long deadline too, so run() would
+    // not return
+    while (done < 2)
+        ioc.run_one();
+    check_eq(ec_a == asio::error::timed_out, true);
+    check_eq(ec_c == asio::error::timed_out, true);
+    check_eq(sem.value(), -1);
+
+    // with no deadlines left the timer is stopped and run() returns
+    sem.release();
+    ioc.restart();
+    ioc.run();
+    check_eq(done, 3);
+    check_eq(!ec_b, true);
+
+    error_code ec_d;
+    sem.async_acquire_until(now - 1s, [&](error_code ec) { ec_d = ec; });
+    ioc.restart();
+    ioc.run();
+    check_eq(ec_d == asio::error::timed_out, true);
+    check_eq(sem.value(), 0);
+
+    return errors;
+}
+
+awaitable< void >
+looped_acquire(async_semaphore &sem, int units, int messages)
+{
+    for (int m = 0; m < messages; ++m)
+    {
+        for (int i = 0; i < units; ++i)
+            co_await sem.async_acquire(use_awaitable);
+        co_await post(use_awaitable);
+        sem.release(units);
+    }
+}
+
+awaitable< void >
+weighted_acquire(async_semaphore &sem, int units, int messages)
+{
+    for (int m = 0; m < messages; ++m)
+    {
+        co_await sem.async_acquire(units, use_awaitable);
+        co_await post(use_awaitable);
+        sem.release(units);
+    }
+}
+
+void benchmark_weighted()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int units    = 256;
+    constexpr int messages = 1000;
+    constexpr int senders  = 4;
+
+    auto run = [&](auto op, const char *name)
+    {
+        auto ioc = asio::io_context(ASIO_CONCURRENCY_HINT_UNSAFE);
+        // a looped sender holds some units while it waits for the rest, so
+        // with fewer than senders * units they could all wait on each other
+        auto sem = async_semaphore(ioc.get_executor(), senders * units);
+        for (int i = 0; i < senders; ++i)
+            co_spawn(ioc, op(sem, units, messages), detached);
+        auto start = clock::now();
+        ioc.run();
+        auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+        std::printf("%s acquire: %lldns per unit\n",
+                    name,
+                    static_cast< long long >(ns / (units * messages * senders)));
+    };
+
+    run(looped_acquire, "  looped");
+    run(weighted_acquire, "weighted");
+}
+
+void benchmark_deadline_expiry()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int waiters = 50000;
+
+    asio::io_context ioc(ASIO_CONCURRENCY_HINT_UNSAFE);
+    async_semaphore  sem{ioc.get_executor(), 0};
+
+    int  expired  = 0;
+    auto deadline = clock::now() + 10ms;
+    auto start    = clock::now();
+    for (int i = 0; i < waiters; ++i)
+        sem.async_acquire_until(deadline, [&](error_code ec) { expired += !!ec; });
+    auto parked = clock::now();
+    ioc.run();
+    auto end = clock::now();
+
+    std::printf("%d timed waiters: %lldns per park, %lldns to expire all "
+                "after the deadline (%d expired)\n",
+                waiters,
+                static_cast< long long >(
+                    std::chrono::nanoseconds(parked - start).count() / waiters),
+                static_cast< long long >(
+                    std::chrono::nanoseconds(end - std::max(deadline, parked))
+                        .count()),
+                expired);
+}
+
+// Each iteration of the || loop parks a wait on the idle semaphore with a
+// connected cancellation slot and cancels it when the other side wins.
+awaitable< void >
+raced_acquire(async_semaphore &sem, async_semaphore &idle, int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        co_await(sem.async_acquire(use_awaitable) ||
+                 idle.async_acquire(use_awaitable));
+        sem.release();
+    }
+}
+
+awaitable< void >
+plain_acquire(async_semaphore &sem, async_semaphore &, int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        co_await sem.async_acquire(use_awaitable);
+        sem.release();
+    }
+}
+
+void benchmark_cancellation()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int iterations = 100000;
+
+    auto run = [&](auto op, const char *name)
+    {
+        auto ioc  = asio::io_context(ASIO_CONCURRENCY_HINT_UNSAFE);
+        auto sem  = async_semaphore(ioc.get_executor(), 1);
+        auto idle = async_semaphore(ioc.get_executor(), 0);
+        co_spawn(ioc, op(sem, idle, iterations), detached);
+        auto start = clock::now();
+        ioc.run();
+        auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+        std::printf("%s: %lldns per acquire/release\n",
+                    name,
+                    static_cast< long long >(ns / iterations));
+    };
+
+    run(plain_acquire, "           acquire");
+    run(raced_acquire, "acquire || acquire");
+}
+
+// Two requests arrive for every one the semaphore can admit. Latency is
+// measured in ticks of the simulated clock, for the requests which were
+// admitted before the run ended.
+template < class QueuePolicy >
+void benchmark_overload(const char *name)
+{
+    constexpr int ticks = 20000;
+
+    asio::io_context ioc(ASIO_CONCURRENCY_HINT_UNSAFE);
+    basic_async_semaphore< asio::io_context::executor_type, QueuePolicy > sem {
+        ioc.get_executor(), 0
+    };
+
+    auto eng  = std::default_random_engine(42);
+    auto dist = std::uniform_int_distribution< int >(0, 9);
+
+    long                now = 0;
+    std::vector< long > latency;
+    latency.reserve(ticks);
+    for (; now < ticks; ++now)
+    {
+        for (int i = 0; i < 2; ++i)
+            sem.async_acquire(bind_wait_priority(
+                dist(eng),
+                [&latency, &now, start = now](error_code ec)
+                {
+                    if (!ec)
+                        latency.push_back(now - start);
+                }));
+        sem.release();
+        ioc.poll();
+    }
+
+    std::sort(latency.begin(), latency.end());
+    auto pct = [&](double p)
+    { return latency[static_cast< std::size_t >(p * (latency.size() - 1))]; };
+    std::printf("%s under 2x overload: p50 %ld ticks, p99 %ld ticks, %zu "
+                "admitted, %d still queued\n",
+                name,
+                pct(0.5),
+                pct(0.99),
+                latency.size(),
+                -sem.value());
+}
+
 int
 main()
 {
     int res = 0;
     res += test_value();
+    res += test_weighted();
+    res += test_pool();
+    res += test_queue_policy();
+    res += test_combined_adapters();
+    res += test_deadline();
+    benchmark_weighted();
+    benchmark_overload< fifo_wait_queue >("    fifo");
+    benchmark_overload< lifo_wait_queue >("    lifo");
+    benchmark_overload< priority_wait_queue >("priority");
+    benchmark_deadline_expiry();
+    benchmark_cancellation();
 
     auto ioc  = asio::io_context(ASIO_CONCURRENCY_HINT_UNSAFE);
     auto sem  = async_semaphore(ioc.get_executor(), 10);
@@ -5,8 +5,12 @@
 
 #include <asioex/condition_variable.hpp>
 #include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
 #include <asio/io_context.hpp>
 
+#include <chrono>
+#include <cstdio>
+
 #define check(Cond) if (!Cond) { printf(__FILE__ "(%d): " #Cond " failed\n", __LINE__); errors++; }
 
 
@@ -42,12 +46,107 @@ asio::awaitable<int> main_impl()
     co_await asio::post(asio::use_awaitable);
     check(fired);
 
+    // a notification nobody is waiting for is not stored
+    fired = false;
+    cond.notify_one();
+    cond.async_wait([&](asio::error_code ec){ assert(!ec); fired = true;});
+    co_await asio::post(asio::use_awaitable);
+    check(!fired);
+    cond.notify_one();
+    co_await asio::post(asio::use_awaitable);
+    check(fired);
+
+    // notify_one skips waiters whose predicate is false
+    bool pred_a = false, pred_b = false, fired_a = false, fired_b = false;
+    cond.async_wait([&]{ return pred_a;},
+                    [&](asio::error_code ec){ assert(!ec); fired_a = true;});
+    cond.async_wait([&]{ return pred_b;},
+                    [&](asio::error_code ec){ assert(!ec); fired_b = true;});
+    pred_b = true;
+    cond.notify_one();
+    co_await asio::post(asio::use_awaitable);
+    check(!fired_a);
+    check(fired_b);
+    check((cond.waiters() == 1u));
+    pred_a = true;
+    cond.notify_all();
+    co_await asio::post(asio::use_awaitable);
+    check(fired_a);
+
     co_return errors;
 }
 
+asio::awaitable<int> mutex_impl()
+{
+    int errors = 0;
+    auto exec = co_await asio::this_coro::executor;
+    asioex::condition_variable cond(exec);
+    asioex::mutex mtx(exec);
+
+    bool ready = false, done = false;
+    asio::co_spawn(
+        exec,
+        [&]() -> asio::awaitable<void>
+        {
+            co_await mtx.async_lock(asio::use_awaitable);
+            co_await cond.async_wait(mtx, [&]{ return ready;}, asio::use_awaitable);
+            // the mutex is owned again on resumption
+            assert(!mtx.try_lock());
+            done = true;
+            mtx.unlock();
+        },
+        asio::detached);
+
+    co_await asio::post(asio::use_awaitable);
+    // the waiter released the mutex while it waits
+    co_await mtx.async_lock(asio::use_awaitable);
+    cond.notify_all();
+    ready = true;
+    mtx.unlock();
+    co_await asio::post(asio::use_awaitable);
+    check(!done);
+
+    co_await mtx.async_lock(asio::use_awaitable);
+    cond.notify_all();
+    mtx.unlock();
+    for (int i = 0; i < 4 && !done; i++)
+        co_await asio::post(asio::use_awaitable);
+    check(done);
+
+    co_return errors;
+}
+
+void benchmark_notify_all()
+{
+    using clock = std::chrono::steady_clock;
+
+    for (std::size_t waiters : {100u, 10000u, 100000u})
+    {
+        asio::io_context ctx;
+        asioex::condition_variable cond(ctx.get_executor());
+
+        std::size_t woken = 0u;
+        for (std::size_t i = 0; i < waiters; ++i)
+            cond.async_wait([&](asio::error_code) { woken++; });
+
+        auto start = clock::now();
+        cond.notify_all();
+        ctx.run();
+        auto end = clock::now();
+
+        assert(woken == waiters);
+        std::printf("notify_all of %zu waiters took %lldns\n",
+                    waiters,
+                    static_cast< long long >(
+                        std::chrono::nanoseconds(end - start).count()));
+    }
+}
+
 int main(int argc, char * argv[])
 {
     int res = 0;
+    benchmark_notify_all();
+
     asio::io_context ctx;
 
     asio::co_spawn(
@@ -60,5 +159,17 @@ int main(int argc, char * argv[])
         });
 
     ctx.run();
+
+    asio::co_spawn(
+        ctx, mutex_impl(),
+        [&res](std::exception_ptr e, int res_)
+        {
+           if (e)
+               std::rethrow_exception(e);
+           res += res_;
+        });
+
+    ctx.restart();
+    ctx.run();
     return res;
 }
\ No newline at end of file
@@ -4,11 +4,20 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <asio.hpp>
+#include <asio/experimental/append.hpp>
 #include <asio/experimental/channel.hpp>
 #include <asio/experimental/deferred.hpp>
 #include <asioex/copy.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #define check_eq(x, y) \
     if (x != y) \
@@ -52,9 +61,554 @@ asio::awaitable<int> main_impl()
     check_eq(res_i.size(), 4u);
     check_eq(res_d.size(), 4u);
 
+    // the same with the source reading ahead of the sink
+    asio::experimental::channel<void(std::error_code, int, double)> chan2{exec, 4};
+    res_i.clear();
+    res_d.clear();
+    for (int i = 1; i <= 4; i++)
+        co_await chan2.async_send(asio::error_code{}, i, 0.4 + i / 100., asio::use_awaitable);
+
+    tim.expires_after(std::chrono::milliseconds(100));
+    tim.async_wait([&](auto) {chan2.cancel(); chan2.close();});
+
+    n = co_await asioex::async_copy(exec, chan2.async_receive(asio::experimental::deferred), sink, 2,
+                                    asio::redirect_error(asio::use_awaitable, ec));
+
+    check_eq(ec , asio::experimental::channel_errc::channel_cancelled);
+    check_eq(n , 4);
+    check_eq(res_i.size(), 4u);
+    for (int i = 0; i < int(res_i.size()); i++)
+        check_eq(res_i[i], i + 1);
+
     co_return errors;
 }
 
+// A source and a sink which each take a pseudo-random time of up to 2ms.
+// Reading ahead overlaps the two, and a deeper pipeline absorbs more jitter.
+void benchmark_pipeline()
+{
+    constexpr int items = 100;
+
+    for (std::size_t depth : {0u, 1u, 2u, 4u, 8u})
+    {
+        asio::io_context ctx;
+        asio::steady_timer source_timer{ctx}, sink_timer{ctx};
+        std::minstd_rand source_rng{1}, sink_rng{2};
+        int produced = 0;
+
+        auto source = [&](auto handler)
+        {
+            source_timer.expires_after(std::chrono::microseconds(source_rng() % 2000));
+            source_timer.async_wait(
+                [&, handler = std::move(handler)](asio::error_code ec) mutable
+                {
+                    if (!ec && produced == items)
+                        ec = asio::error::eof;
+                    std::move(handler)(ec, produced++);
+                });
+        };
+        auto sink = [&](int, auto handler)
+        {
+            sink_timer.expires_after(std::chrono::microseconds(sink_rng() % 2000));
+            sink_timer.async_wait(std::move(handler));
+        };
+
+        std::size_t n = 0;
+        auto start = std::chrono::steady_clock::now();
+        asioex::async_copy(ctx.get_executor(), source, sink, depth,
+                           [&](asio::error_code, std::size_t n_) { n = n_; });
+        ctx.run();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        std::cout << "depth " << depth << ": " << n << " items in " << ms << "ms" << std::endl;
+    }
+}
+
+// A source which completes after one posted round trip and a sink which takes
+// two, so that the source is always ready to run ahead. It gets at most depth
+// results ahead of the sink, or one when the sink is idle.
+int test_pipeline()
+{
+    int errors = 0;
+    constexpr int items = 100;
+
+    for (std::size_t depth : {0u, 1u, 4u})
+    {
+        asio::io_context ctx;
+        int reads = 0, writes = 0, most_ahead = 0;
+        auto source = [&](auto handler)
+        {
+            most_ahead = (std::max)(most_ahead, ++reads - writes);
+            asio::error_code ec;
+            if (reads > items)
+                ec = asio::error::eof;
+            asio::post(ctx, asio::experimental::append(std::move(handler), ec, reads));
+        };
+        auto sink = [&](int, auto handler)
+        {
+            writes++;
+            asio::post(ctx, [&ctx, handler = std::move(handler)]() mutable
+            {
+                asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+            });
+        };
+
+        std::size_t n = 0;
+        asioex::async_copy(ctx.get_executor(), source, sink, depth,
+                           [&](asio::error_code, std::size_t n_) { n = n_; });
+        ctx.run();
+        check_eq(n, items);
+        check_eq(most_ahead, (std::max)(int(depth), 1));
+    }
+
+    // as without depth, any kind of cancellation ends the copy after a write
+    {
+        asio::io_context ctx;
+        asio::cancellation_signal sig;
+        int reads = 0, writes = 0;
+        auto source = [&](auto handler)
+        {
+            asio::error_code ec;
+            if (reads == items)
+                ec = asio::error::eof;
+            asio::post(ctx, asio::experimental::append(std::move(handler), ec, reads++));
+        };
+        auto sink = [&](int, auto handler)
+        {
+            if (++writes == 3)
+                sig.emit(asio::cancellation_type::partial);
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+        };
+
+        asio::error_code ec;
+        std::size_t n = 0;
+        asioex::async_copy(ctx.get_executor(), source, sink, 2,
+                           asio::bind_cancellation_slot(sig.slot(),
+                                                        [&](asio::error_code ec_, std::size_t n_)
+                                                        {
+                                                            ec = ec_;
+                                                            n = n_;
+                                                        }));
+        ctx.run();
+        check_eq(ec, asio::error::operation_aborted);
+        check_eq(n, 3u);
+    }
+
+    // a failed write cancels the read ahead, even if the source would never
+    // complete by itself
+    {
+        asio::io_context ctx;
+        asio::steady_timer never{ctx, asio::steady_timer::time_point::max()};
+        bool first = true;
+        auto source = [&](auto handler)
+        {
+            if (std::exchange(first, false))
+                asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}, 0));
+            else
+                never.async_wait(asio::experimental::append(std::move(handler), 0));
+        };
+        auto sink = [&](int, auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error::fault));
+        };
+
+        asio::error_code ec;
+        std::size_t n = 0;
+        asioex::async_copy(ctx.get_executor(), source, sink, 2,
+                           [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+        ctx.run();
+        check_eq(ec, asio::error::fault);
+        check_eq(n, 0u);
+    }
+
+    return errors;
+}
+
+// A source which has all its values ready, and a sink which takes 100us per
+// call no matter how many values it is given, so that batching pays off.
+int test_batched()
+{
+    int errors = 0;
+    constexpr int items = 1000;
+
+    for (std::size_t max_items : {1u, 16u, 64u})
+    {
+        asio::io_context ctx;
+        asio::steady_timer sink_timer{ctx};
+        int produced = 0;
+        std::vector<int> written;
+        asioex::copy_batch_stats stats;
+
+        auto source = [&](auto handler)
+        {
+            asio::post(ctx, [&, handler = std::move(handler)]() mutable
+            {
+                asio::error_code ec;
+                if (produced == items)
+                    ec = asio::error::eof;
+                std::move(handler)(ec, produced++);
+            });
+        };
+        auto sink = [&](std::span<int> batch, auto handler)
+        {
+            written.insert(written.end(), batch.begin(), batch.end());
+            sink_timer.expires_after(std::chrono::microseconds(100));
+            sink_timer.async_wait(std::move(handler));
+        };
+
+        asio::error_code ec;
+        std::size_t n = 0;
+        auto start = std::chrono::steady_clock::now();
+        asioex::async_copy_batched<int>(ctx.get_executor(), source, sink,
+                                        asioex::copy_batch_limits<>{.max_items = max_items, .stats = &stats},
+                                        [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+        ctx.run();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        check_eq(ec, asio::error::eof);
+        check_eq(n, items);
+        check_eq(stats.items, items);
+        check_eq(stats.largest, max_items);
+        check_eq(written.size(), items);
+        for (int i = 0; i < int(written.size()); i++)
+            check_eq(written[i], i);
+
+        std::cout << "max_items " << max_items << ": " << n << " items in " << stats.batches
+                  << " batches, " << ms << "ms" << std::endl;
+    }
+
+    // a source slower than the sink gets single items, unless the batch may wait
+    for (auto delay : {std::chrono::milliseconds(0), std::chrono::milliseconds(10)})
+    {
+        asio::io_context ctx;
+        asio::steady_timer source_timer{ctx};
+        int produced = 0;
+        asioex::copy_batch_stats stats;
+
+        auto source = [&](auto handler)
+        {
+            source_timer.expires_after(std::chrono::milliseconds(1));
+            source_timer.async_wait(
+                [&, handler = std::move(handler)](asio::error_code ec) mutable
+                {
+                    if (!ec && produced == 20)
+                        ec = asio::error::eof;
+                    std::move(handler)(ec, produced++);
+                });
+        };
+        auto sink = [&](std::span<int>, auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+        };
+
+        std::size_t n = 0;
+        asioex::async_copy_batched<int>(ctx.get_executor(), source, sink,
+                                        asioex::copy_batch_limits<>{.max_delay = delay, .stats = &stats},
+                                        [&](asio::error_code, std::size_t n_) { n = n_; });
+        ctx.run();
+
+        check_eq(n, 20);
+        if (delay == delay.zero())
+            check_eq(stats.largest, 1u);
+        std::cout << "max_delay " << delay.count() << "ms: " << stats.batches << " batches, largest "
+                  << stats.largest << std::endl;
+    }
+
+    // a failed write cancels the next read, even if the source would never
+    // complete by itself
+    {
+        asio::io_context ctx;
+        asio::steady_timer never{ctx, asio::steady_timer::time_point::max()};
+        bool first = true;
+        auto source = [&](auto handler)
+        {
+            if (std::exchange(first, false))
+                asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}, 0));
+            else
+                never.async_wait(asio::experimental::append(std::move(handler), 0));
+        };
+        auto sink = [&](std::span<int>, auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error::fault));
+        };
+
+        asio::error_code ec;
+        std::size_t n = 0;
+        asioex::async_copy_batched<int>(ctx.get_executor(), source, sink, asioex::copy_batch_limits<>{},
+                                        [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+        ctx.run();
+
+        check_eq(ec, asio::error::fault);
+        check_eq(n, 0u);
+    }
+
+    return errors;
+}
+
+// Four sinks which take 0, 100, 200 and 2000us per value. With the default
+// options the slowest sets the pace. With a quorum of three it falls behind
+// and gets dropped.
+int test_broadcast()
+{
+    int errors = 0;
+    constexpr int items = 50;
+
+    for (std::size_t quorum : {4u, 3u})
+    {
+        asio::io_context ctx;
+        int produced = 0;
+        std::vector<std::vector<int>> written(4);
+        std::vector<std::unique_ptr<asio::steady_timer>> timers;
+        for (int i = 0; i < 4; i++)
+            timers.push_back(std::make_unique<asio::steady_timer>(ctx));
+
+        auto source = [&](auto handler)
+        {
+            asio::post(ctx, [&, handler = std::move(handler)]() mutable
+            {
+                asio::error_code ec;
+                if (produced == items)
+                    ec = asio::error::eof;
+                std::move(handler)(ec, produced++);
+            });
+        };
+        auto make_sink = [&](int i)
+        {
+            return [&, i](int const & value, auto handler)
+            {
+                written[i].push_back(value);
+                timers[i]->expires_after(std::chrono::microseconds(i == 3 ? 2000 : 100 * i));
+                timers[i]->async_wait(std::move(handler));
+            };
+        };
+        std::vector<decltype(make_sink(0))> sinks;
+        for (int i = 0; i < 4; i++)
+            sinks.push_back(make_sink(i));
+
+        asioex::broadcast_copy_stats stats;
+        asioex::broadcast_copy_options options{.quorum = quorum, .max_lag = 5, .stats = &stats};
+        asio::error_code ec;
+        std::size_t n = 0;
+        asioex::async_broadcast_copy<int>(ctx.get_executor(), source, sinks, options,
+                                          [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+        ctx.run();
+
+        check_eq(ec, asio::error::eof);
+        check_eq(n, items);
+        for (int i = 0; i < 3; i++)
+        {
+            check_eq(stats.written[i], items);
+            check_eq(written[i].size(), items);
+        }
+        for (auto & w : written)
+            for (int i = 0; i < int(w.size()); i++)
+                check_eq(w[i], i);
+        if (quorum == 4u)
+        {
+            check_eq(stats.written[3], items);
+        }
+        else
+        {
+            check_eq(stats.errors[3], asio::error::no_buffer_space);
+        }
+    }
+
+    // With no quorum the next read starts at once and waits on a source
+    // that never completes by itself. Both sinks fail on the first value,
+    // which must cancel that read.
+    {
+        asio::io_context ctx;
+        asio::steady_timer never{ctx, asio::steady_timer::time_point::max()};
+        bool first = true;
+        auto source = [&](auto handler)
+        {
+            if (std::exchange(first, false))
+                asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}, 0));
+            else
+                never.async_wait(asio::experimental::append(std::move(handler), 0));
+        };
+        auto sink = [&](int const &, auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error::fault));
+        };
+        std::vector<decltype(sink)> sinks(2, sink);
+
+        asio::error_code ec;
+        std::size_t n = 0;
+        asioex::async_broadcast_copy<int>(ctx.get_executor(), source, sinks, {.quorum = 0u},
+                                          [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+        ctx.run();
+
+        check_eq(ec, asio::error::fault);
+        check_eq(n, 1u);
+    }
+
+    // without sinks the copy completes at once, but from the event loop
+    {
+        asio::io_context ctx;
+        auto source = [&](auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}, 0));
+        };
+        auto sink = [&](int const &, auto handler)
+        {
+            asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+        };
+        std::vector<decltype(sink)> sinks;
+
+        asio::error_code ec = asio::error::fault;
+        std::size_t n = 1u;
+        bool done = false;
+        asioex::async_broadcast_copy<int>(ctx.get_executor(), source, sinks, {},
+                                          [&](asio::error_code ec_, std::size_t n_)
+                                          {
+                                              ec = ec_;
+                                              n = n_;
+                                              done = true;
+                                          });
+        check_eq(done, false);
+        ctx.run();
+        check_eq(done, true);
+        check_eq(ec, asio::error_code{});
+        check_eq(n, 0u);
+    }
+
+    return errors;
+}
+
+// One source of 512 byte messages fanned out to up to 64 sinks, which each
+// take a posted round trip per message. The broadcast hands every sink a
+// reference to the one message. The alternative copies the message for each
+// sink and waits for all of them before reading the next.
+void benchmark_broadcast()
+{
+    constexpr int items = 10000;
+    using message = std::string;
+
+    for (std::size_t fan_out : {1u, 4u, 16u, 64u})
+    {
+        double broadcast_ms, copying_ms;
+        {
+            asio::io_context ctx;
+            int produced = 0;
+            auto source = [&](auto handler)
+            {
+                asio::error_code ec;
+                if (produced++ == items)
+                    ec = asio::error::eof;
+                asio::post(ctx, asio::experimental::append(std::move(handler), ec, message(512, 'x')));
+            };
+            auto make_sink = [&]
+            {
+                return [&](message const &, auto handler)
+                {
+                    asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+                };
+            };
+            std::vector<decltype(make_sink())> sinks(fan_out, make_sink());
+
+            auto start = std::chrono::steady_clock::now();
+            asioex::async_broadcast_copy<message>(ctx.get_executor(), source, sinks, {},
+                                                  [](asio::error_code, std::size_t) {});
+            ctx.run();
+            broadcast_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        {
+            asio::io_context ctx;
+            int produced = 0;
+            auto source = [&](auto handler)
+            {
+                asio::error_code ec;
+                if (produced++ == items)
+                    ec = asio::error::eof;
+                asio::post(ctx, asio::experimental::append(std::move(handler), ec, message(512, 'x')));
+            };
+            auto sink = [&](message const & m, auto handler)
+            {
+                auto pending = std::make_shared<std::size_t>(fan_out);
+                auto h = std::make_shared<decltype(handler)>(std::move(handler));
+                for (std::size_t i = 0; i < fan_out; i++)
+                    asio::post(ctx, [pending, h, copy = m]
+                    {
+                        if (--*pending == 0u)
+                            std::move(*h)(asio::error_code{});
+                    });
+            };
+
+            auto start = std::chrono::steady_clock::now();
+            asioex::async_copy(source, sink, [](asio::error_code, std::size_t) {});
+            ctx.run();
+            copying_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << "fan out " << fan_out << ": broadcast " << broadcast_ms << "ms, copy per sink "
+                  << copying_ms << "ms" << std::endl;
+    }
+}
+
+// 50 values of 1000 bytes at 100kB/s, with a 10kB burst, take about 0.4s.
+// Another thread watches the progress meanwhile.
+int test_progress()
+{
+    int errors = 0;
+    constexpr int items = 50;
+
+    asio::io_context ctx;
+    int produced = 0;
+    auto source = [&](auto handler)
+    {
+        asio::post(ctx, [&, handler = std::move(handler)]() mutable
+        {
+            asio::error_code ec;
+            if (produced++ == items)
+                ec = asio::error::eof;
+            std::move(handler)(ec, std::string(1000, 'x'));
+        });
+    };
+    auto sink = [&](std::string const &, auto handler)
+    {
+        asio::post(ctx, asio::experimental::append(std::move(handler), asio::error_code{}));
+    };
+
+    asioex::copy_progress progress;
+    std::atomic<bool> done{false};
+    std::size_t seen = 0u;
+    std::thread watcher{[&]
+    {
+        while (!done)
+        {
+            auto bytes = progress.bytes.load(std::memory_order_relaxed);
+            if (bytes < seen)
+                errors++;
+            seen = bytes;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }};
+
+    asio::error_code ec;
+    std::size_t n = 0;
+    auto start = std::chrono::steady_clock::now();
+    asioex::async_copy(ctx.get_executor(), source, sink,
+                       asioex::copy_options{.progress = &progress, .rate_limit = 100000, .burst = 10000},
+                       [&](asio::error_code ec_, std::size_t n_) { ec = ec_; n = n_; });
+    ctx.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    watcher.join();
+
+    check_eq(ec, asio::error::eof);
+    check_eq(n, items);
+    check_eq(progress.items.load(), items);
+    check_eq(progress.bytes.load(), items * 1000u);
+    check_eq(elapsed > std::chrono::milliseconds(350), true);
+    // only elements which are plain bytes are counted
+    check_eq(asioex::detail::copied_bytes(std::vector<int>(3)), 3 * sizeof(int));
+    check_eq(asioex::detail::copied_bytes(std::vector<std::string>(3, std::string(1000, 'x'))), 0u);
+    std::cout << "rate limited: " << std::chrono::duration<double>(elapsed).count() << "s" << std::endl;
+
+    return errors;
+}
+
 int
 main()
 {
@@ -71,6 +625,12 @@ main()
                    });
 
     ctx.run();
+    res += test_pipeline();
+    benchmark_pipeline();
+    res += test_batched();
+    res += test_broadcast();
+    res += test_progress();
+    benchmark_broadcast();
 
-    return 0;
+    return res;
 }
\ No newline at end of file
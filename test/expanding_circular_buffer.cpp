@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asioex/detail/expanding_circular_buffer.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+
+using asioex::detail::expanding_circular_buffer;
+
+#define check_eq(X, Y)                                                         \
+    if ((X) != (Y))                                                            \
+    {                                                                          \
+        printf(#X " == " #Y " failed: %lld != %lld\n",                         \
+               static_cast< long long >(X),                                    \
+               static_cast< long long >(Y));                                   \
+        errors++;                                                              \
+    }
+
+static int live = 0;
+
+struct counted
+{
+    explicit counted(int v)
+    : value(v)
+    {
+        ++live;
+    }
+
+    counted(counted &&other) noexcept
+    : value(other.value)
+    {
+        ++live;
+    }
+
+    counted(counted const &) = delete;
+
+    ~counted()
+    {
+        --live;
+    }
+
+    int value;
+};
+
+static std::size_t allocated = 0;
+
+template < class T >
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template < class U >
+    counting_allocator(counting_allocator< U > const &)
+    {
+    }
+
+    T *
+    allocate(std::size_t n)
+    {
+        allocated += n;
+        return std::allocator< T >().allocate(n);
+    }
+
+    void
+    deallocate(T *p, std::size_t n)
+    {
+        allocated -= n;
+        std::allocator< T >().deallocate(p, n);
+    }
+
+    friend bool
+    operator==(counting_allocator const &, counting_allocator const &)
+    {
+        return true;
+    }
+};
+
+int
+test_move_only()
+{
+    int errors = 0;
+
+    {
+        expanding_circular_buffer< std::unique_ptr< int > > buf;
+        check_eq(buf.capacity(), 0);
+
+        // wrap, then grow while wrapped
+        for (int i = 0; i < 10; ++i)
+            buf.push(std::make_unique< int >(i));
+        for (int i = 0; i < 10; ++i)
+            check_eq(*buf.pop(), i);
+        for (int i = 0; i < 40; ++i)
+            buf.push(std::make_unique< int >(i));
+        check_eq(buf.capacity(), 64);
+        for (int i = 0; i < 40; ++i)
+            check_eq(*buf.pop(), i);
+        check_eq(buf.empty(), true);
+    }
+
+    {
+        expanding_circular_buffer< counted, counting_allocator< counted > >
+            buf;
+        for (int i = 0; i < 100; ++i)
+            buf.emplace(i);
+        check_eq(live, 100);
+        check_eq(allocated, 128);
+        buf.pop();
+        check_eq(live, 99);
+        check_eq(buf.front().value, 1);
+    }
+    check_eq(live, 0);
+    check_eq(allocated, 0);
+
+    return errors;
+}
+
+int
+test_shrink()
+{
+    int errors = 0;
+
+    expanding_circular_buffer< int > buf { true };
+    for (int i = 0; i < 1000; ++i)
+        buf.push(i);
+    check_eq(buf.capacity(), 1024);
+
+    // halved at one eighth full
+    while (buf.size() > 128)
+        buf.pop();
+    check_eq(buf.capacity(), 512);
+    check_eq(buf.front(), 1000 - 128);
+
+    // and then not again until one eighth of the new capacity
+    while (buf.size() > 65)
+        buf.pop();
+    check_eq(buf.capacity(), 512);
+    buf.pop();
+    check_eq(buf.capacity(), 256);
+
+    // never below the initial capacity
+    buf.clear();
+    check_eq(buf.capacity(),
+             expanding_circular_buffer< int >::initial_capacity);
+
+    // without shrink enabled the storage is kept
+    expanding_circular_buffer< int > keep;
+    for (int i = 0; i < 1000; ++i)
+        keep.push(i);
+    keep.clear();
+    check_eq(keep.capacity(), 1024);
+
+    return errors;
+}
+
+int
+test_spans()
+{
+    int errors = 0;
+
+    expanding_circular_buffer< int > buf;
+    for (int i = 0; i < 12; ++i)
+        buf.push(i);
+    buf.consume(10);
+    for (int i = 12; i < 20; ++i)
+        buf.push(i);
+
+    // 10 elements, wrapped after the first 6
+    auto front = buf.front_span();
+    auto back  = buf.back_span();
+    check_eq(front.size(), 6);
+    check_eq(back.size(), 4);
+    check_eq(front[0], 10);
+    check_eq(back[0], 16);
+
+    buf.consume(front.size());
+    check_eq(buf.front_span().size(), 4);
+    check_eq(buf.back_span().size(), 0);
+    check_eq(buf.front(), 16);
+
+    return errors;
+}
+
+void
+benchmark_deque()
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int rounds = 10'000;
+    constexpr int burst  = 1'000;
+
+    auto run = [&](auto &q, const char *name)
+    {
+        auto start = clock::now();
+        long sum   = 0;
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (int i = 0; i < burst; ++i)
+                q.push_back(i);
+            for (int i = 0; i < burst; ++i)
+                sum += q.pop_front();
+        }
+        auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+        std::printf("%s: %lldps per push and pop (%ld)\n",
+                    name,
+                    static_cast< long long >(ns * 1000 / (rounds * burst)),
+                    sum);
+    };
+
+    struct ring
+    {
+        void
+        push_back(int i)
+        {
+            buf.push(i);
+        }
+
+        int
+        pop_front()
+        {
+            return buf.pop();
+        }
+
+        expanding_circular_buffer< int > buf;
+    };
+
+    struct deque
+    {
+        void
+        push_back(int i)
+        {
+            buf.push_back(i);
+        }
+
+        int
+        pop_front()
+        {
+            auto i = buf.front();
+            buf.pop_front();
+            return i;
+        }
+
+        std::deque< int > buf;
+    };
+
+    ring  r;
+    deque d;
+    run(r, "  ring");
+    run(d, " deque");
+}
+
+int
+main()
+{
+    int res = 0;
+    res += test_move_only();
+    res += test_shrink();
+    res += test_spans();
+    benchmark_deque();
+    return res;
+}
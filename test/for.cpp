@@ -9,6 +9,12 @@
 
 #include <asio/experimental/channel.hpp>
 
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
 #include "doctest.h"
@@ -31,6 +37,28 @@ asio::awaitable<std::size_t> for_chan_test(asio::experimental::channel<void(asio
     co_return sz;
 }
 
+asio::awaitable<std::size_t> for_batch_chan_test(asio::experimental::channel<void(asio::error_code, int)> & chan)
+{
+    std::size_t sz = 0u;
+    std::array<int, 3> buffer;
+    try
+    {
+        co_for_batch (values, buffer, chan, asio::use_awaitable)
+        {
+            printf("for_batch_chan_test: %d items\n", (int)values.size());
+            CHECK(!values.empty());
+            CHECK(values.size() <= buffer.size());
+            for (auto value : values)
+                CHECK(value == sz++);
+        }
+    }
+    catch(asio::system_error & se)
+    {
+        CHECK(se.code() == asio::error::fault);
+    }
+    co_return sz;
+}
+
 asio::experimental::coro<int> cr(asio::any_io_executor exec)
 {
     co_yield 10;
@@ -82,4 +110,85 @@ TEST_CASE("for")
     chan.async_send(asio::error::fault, 5, asio::detached);
 
     ctx.run();
-}
\ No newline at end of file
+}
+
+TEST_CASE("for_batch")
+{
+    asio::io_context ctx;
+    asio::experimental::channel<void(asio::error_code, int)> chan{ctx, 8};
+    asio::co_spawn(ctx, for_batch_chan_test(chan),
+                   [](std::exception_ptr e, std::size_t sz)
+                   {
+                       CHECK(!e);
+                       CHECK(sz == 7);
+                   });
+
+    for (int i = 0; i < 7; i++)
+        chan.async_send(asio::error_code{}, i, asio::detached);
+    chan.async_send(asio::error::fault, 7, asio::detached);
+
+    ctx.run();
+
+    std::span<int> empty;
+    CHECK_THROWS_AS(asioex::range_from(chan, empty), std::invalid_argument);
+}
+
+// The per-item cost of co_for over a channel, against receiving in a plain
+// loop. The producer runs on the same io_context, so both include the send.
+TEST_CASE("for benchmark")
+{
+    constexpr int items = 1'000'000;
+    using channel = asio::experimental::channel<void(asio::error_code, int)>;
+
+    auto produce = [](channel & chan) -> asio::awaitable<void>
+    {
+        for (int i = 0; i < items; i++)
+            co_await chan.async_send(asio::error_code{}, i, asio::use_awaitable);
+    };
+
+    auto run = [&](const char * name, auto consume)
+    {
+        asio::io_context ctx;
+        channel chan{ctx, 1024};
+        long sum = 0;
+        asio::co_spawn(ctx, produce(chan), asio::detached);
+        asio::co_spawn(ctx, consume(chan, sum), asio::detached);
+
+        auto start = std::chrono::steady_clock::now();
+        ctx.run();
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        CHECK(sum == long(items) * (items - 1) / 2);
+        printf("%s: %.1fns per item\n", name, ns / items);
+    };
+
+    run("       co_for", [](channel & chan, long & sum) -> asio::awaitable<void>
+    {
+        int n = 0;
+        co_for (value, chan, asio::use_awaitable)
+        {
+            sum += value;
+            if (++n == items)
+                break;
+        }
+    });
+
+    run("  manual loop", [](channel & chan, long & sum) -> asio::awaitable<void>
+    {
+        for (int n = 0; n < items; n++)
+            sum += co_await chan.async_receive(asio::use_awaitable);
+    });
+
+    run(" co_for_batch", [](channel & chan, long & sum) -> asio::awaitable<void>
+    {
+        int n = 0;
+        std::array<int, 64> buffer;
+        co_for_batch (values, buffer, chan, asio::use_awaitable)
+        {
+            for (auto value : values)
+                sum += value;
+            n += int(values.size());
+            if (n == items)
+                break;
+        }
+    });
+}
@@ -4,6 +4,7 @@
 #include <asio/thread_pool.hpp>
 #include <asioex/async_semaphore.hpp>
 
+#include <chrono>
 #include <iostream>
 #include <mutex>
 #include <thread>
@@ -43,9 +44,9 @@ long_running_task(std::string const &id, io_semaphore &sem)
 
     println("long running task ", id, " complete");
     // signal the waiter that we are done
-    // Note: must dispatch to the correct executor as the async_semaphore is not
-    // thread-safe
-    asio::dispatch(sem.get_executor(), [&sem] { sem.release(); });
+    // Note: release itself is not thread-safe, release_from_any_thread hands
+    // the release over to the semaphore's executor
+    sem.release_from_any_thread();
 }
 
 void
@@ -75,6 +76,46 @@ initiate(asio::io_context::executor_type  my_exec,
         });
 }
 
+/// @brief Measure how fast worker threads can report completions.
+/// @details Every worker releases the semaphore once per simulated task, while
+/// a single acquire for all of the units waits on the io_context.
+template < class Release >
+void
+benchmark_release(char const *name, Release release)
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int threads    = 4;
+    constexpr int per_thread = 250000;
+
+    asio::io_context  ioc;
+    io_semaphore      sem(ioc.get_executor(), 0);
+    asio::thread_pool workers(threads);
+
+    bool done  = false;
+    auto start = clock::now();
+    sem.async_acquire(threads * per_thread,
+                      [&done](asio::error_code ec) { done = !ec; });
+    for (int t = 0; t < threads; ++t)
+        asio::post(workers,
+                   [&]
+                   {
+                       for (int i = 0; i < per_thread; ++i)
+                           release(sem);
+                   });
+    ioc.run();
+    auto ns = std::chrono::nanoseconds(clock::now() - start).count();
+    workers.join();
+
+    println(name,
+            ": ",
+            ns / (threads * per_thread),
+            "ns per completion from ",
+            threads,
+            " threads",
+            done ? "" : " (FAILED)");
+}
+
 int
 main()
 {
@@ -93,5 +134,14 @@ main()
     ioc.run();
     workers.join();
 
+    benchmark_release("       dispatch release",
+                      [](io_semaphore &sem)
+                      {
+                          asio::dispatch(sem.get_executor(),
+                                         [&sem] { sem.release(); });
+                      });
+    benchmark_release("release_from_any_thread",
+                      [](io_semaphore &sem) { sem.release_from_any_thread(); });
+
     println("program stopped");
 }
\ No newline at end of file
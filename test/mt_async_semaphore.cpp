@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/strand.hpp>
+#include <asio/use_awaitable.hpp>
+#include <asioex/mt/async_semaphore.hpp>
+#include <asioex/st/async_semaphore.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("mt::async_semaphore");
+
+TEST_CASE("value")
+{
+    asio::io_context            ioc;
+    asioex::mt::async_semaphore sem { ioc.get_executor(), 0 };
+
+    CHECK(sem.value() == 0);
+    sem.release();
+    CHECK(sem.value() == 1);
+    CHECK(sem.try_acquire());
+    CHECK(!sem.try_acquire());
+    CHECK(sem.value() == 0);
+
+    int done = 0;
+    sem.async_acquire([&](asio::error_code ec) { CHECK(!ec); ++done; });
+    sem.async_acquire([&](asio::error_code ec) { CHECK(!ec); ++done; });
+    CHECK(sem.value() == -2);
+
+    sem.release();
+    sem.release();
+    CHECK(sem.value() == 0);
+    ioc.run();
+    CHECK(done == 2);
+}
+
+TEST_CASE("destruction aborts waiters")
+{
+    asio::io_context ioc;
+    asio::error_code ec;
+    {
+        asioex::mt::async_semaphore sem { ioc.get_executor(), 0 };
+        sem.async_acquire([&](asio::error_code ec_) { ec = ec_; });
+    }
+    ioc.run();
+    CHECK(ec == asio::error::operation_aborted);
+}
+
+template < class Semaphore >
+asio::awaitable< void >
+hammer(Semaphore &sem, std::atomic< int > &inside, int &violations, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        co_await sem.async_acquire(asio::use_awaitable);
+        if (inside.fetch_add(1) >= 4)
+            ++violations;
+        inside.fetch_sub(1);
+        sem.release();
+    }
+}
+
+TEST_CASE("concurrent acquire and release")
+{
+    asio::io_context            ioc;
+    asioex::mt::async_semaphore sem { ioc.get_executor(), 4 };
+    std::atomic< int >          inside { 0 };
+    std::vector< int >          violations(64, 0);
+
+    for (auto &v : violations)
+        asio::co_spawn(ioc, hammer(sem, inside, v, 1000), asio::detached);
+
+    std::vector< std::thread > threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&] { ioc.run(); });
+    for (auto &t : threads)
+        t.join();
+
+    for (auto v : violations)
+        CHECK(v == 0);
+    CHECK(sem.value() == 4);
+}
+
+template < class Semaphore, class Executor >
+std::chrono::nanoseconds
+run_benchmark(std::size_t nthreads, Executor exec, asio::io_context &ioc)
+{
+    using clock = std::chrono::steady_clock;
+
+    Semaphore                  sem { exec, 4 };
+    std::atomic< int >         inside { 0 };
+    std::vector< int >         violations(64, 0);
+    std::vector< std::thread > threads;
+
+    for (auto &v : violations)
+        asio::co_spawn(exec, hammer(sem, inside, v, 10000), asio::detached);
+
+    auto start = clock::now();
+    for (std::size_t i = 0; i < nthreads; ++i)
+        threads.emplace_back([&] { ioc.run(); });
+    for (auto &t : threads)
+        t.join();
+    return clock::now() - start;
+}
+
+TEST_CASE("strand vs mt benchmark")
+{
+    for (std::size_t nthreads : { 1u, 4u, 16u })
+    {
+        {
+            asio::io_context ioc;
+            auto             strand = asio::make_strand(ioc.get_executor());
+            auto             t      = run_benchmark<
+                asioex::st::basic_async_semaphore< decltype(strand) > >(
+                nthreads, strand, ioc);
+            std::printf("strand st::async_semaphore %2zu threads took %lldns\n",
+                        nthreads,
+                        static_cast< long long >(t.count()));
+        }
+        {
+            asio::io_context ioc;
+            auto             t = run_benchmark<
+                asioex::mt::basic_async_semaphore<
+                    asio::io_context::executor_type > >(
+                nthreads, ioc.get_executor(), ioc);
+            std::printf("       mt::async_semaphore %2zu threads took %lldns\n",
+                        nthreads,
+                        static_cast< long long >(t.count()));
+        }
+    }
+}
+
+TEST_SUITE_END();
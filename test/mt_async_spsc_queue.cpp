@@ -0,0 +1,290 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+
+#include <asio/bind_cancellation_slot.hpp>
+#include <asio/cancellation_signal.hpp>
+#include <asio/io_context.hpp>
+#include <asioex/detail/expanding_circular_buffer.hpp>
+#include <asioex/detail/spsc_ring.hpp>
+#include <asioex/mt/async_spsc_queue.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("mt::async_spsc_queue");
+
+using executor   = asio::io_context::executor_type;
+using queue_type = asioex::mt::basic_async_spsc_queue< int, executor >;
+
+TEST_CASE("ring")
+{
+    asioex::detail::spsc_ring< std::unique_ptr< int > > ring { 3 };
+    CHECK(ring.capacity() == 4);
+    CHECK(ring.empty());
+
+    for (int i = 0; i < 4; ++i)
+        CHECK(ring.try_push(std::make_unique< int >(i)));
+    auto extra = std::make_unique< int >(4);
+    CHECK(!ring.try_push(std::move(extra)));
+    CHECK(extra);
+
+    std::array< std::unique_ptr< int >, 3 > out;
+    CHECK(ring.try_pop_some(out) == 3);
+    CHECK(*out[2] == 2);
+
+    // wraps, and the ring destroys what is left in it
+    std::array< std::unique_ptr< int >, 3 > in;
+    for (auto &p : in)
+        p = std::make_unique< int >(5);
+    CHECK(ring.try_push_some(in) == 3);
+    CHECK(!in[0]);
+    std::unique_ptr< int > p;
+    CHECK(ring.try_pop(p));
+    CHECK(*p == 3);
+}
+
+TEST_CASE("pop waits for push")
+{
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 4 };
+
+    int value = 0;
+    q.async_pop(
+        [&](asio::error_code ec, int v)
+        {
+            CHECK(!ec);
+            value = v;
+        });
+    ioc.poll();
+    CHECK(value == 0);
+
+    CHECK(q.try_push(7));
+    ioc.run();
+    CHECK(value == 7);
+
+    // an item already there is taken without parking
+    CHECK(q.try_push(8));
+    q.async_pop([&](asio::error_code, int v) { value = v; });
+    ioc.restart();
+    ioc.run();
+    CHECK(value == 8);
+}
+
+TEST_CASE("close")
+{
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 4 };
+
+    std::array< int, 4 > out {};
+    asio::error_code     ec;
+    std::size_t          n = 0;
+    q.async_pop_some(out,
+                     [&](asio::error_code ec_, std::size_t n_)
+                     {
+                         ec = ec_;
+                         n  = n_;
+                     });
+
+    std::array< int, 2 > in { 1, 2 };
+    CHECK(q.try_push_some(in) == 2);
+    q.close();
+    ioc.run();
+    CHECK(!ec);
+    CHECK(n == 2);
+    CHECK(out[1] == 2);
+
+    q.async_pop([&](asio::error_code ec_, int) { ec = ec_; });
+    ioc.restart();
+    ioc.run();
+    CHECK(ec == asio::error::eof);
+}
+
+TEST_CASE("cancel")
+{
+    asio::io_context          ioc;
+    asio::cancellation_signal sig;
+    queue_type                q { ioc.get_executor(), 4 };
+
+    asio::error_code ec;
+    q.async_pop(asio::bind_cancellation_slot(
+        sig.slot(), [&](asio::error_code ec_, int) { ec = ec_; }));
+    sig.emit(asio::cancellation_type::terminal);
+
+    // the wakeup for this push finds no waiter, and the item stays queued
+    CHECK(q.try_push(1));
+    ioc.run();
+    CHECK(ec == asio::error::operation_aborted);
+    int v = 0;
+    CHECK(q.try_pop(v));
+    CHECK(v == 1);
+}
+
+template < class Queue >
+void
+produce(Queue &q, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        int v = i;
+        while (!q.try_push(std::move(v)))
+            std::this_thread::yield();
+    }
+}
+
+TEST_CASE("producer thread")
+{
+    constexpr int n = 100000;
+
+    asio::io_context ioc;
+    queue_type       q { ioc.get_executor(), 64 };
+
+    std::array< int, 16 > out;
+    int                   expect = 0;
+    bool                  in_order = true;
+    bool                  eof      = false;
+    auto                  next     = [&](auto &self) -> void
+    {
+        q.async_pop_some(out,
+                         [&, self](asio::error_code ec, std::size_t got)
+                         {
+                             if (ec)
+                             {
+                                 eof = ec == asio::error::eof;
+                                 return;
+                             }
+                             for (std::size_t i = 0; i < got; ++i)
+                                 in_order &= out[i] == expect++;
+                             self(self);
+                         });
+    };
+    next(next);
+
+    std::thread producer(
+        [&]
+        {
+            produce(q, n);
+            q.close();
+        });
+    ioc.run();
+    producer.join();
+
+    CHECK(in_order);
+    CHECK(expect == n);
+    CHECK(eof);
+}
+
+/// A ring guarded by a mutex, to compare against.
+struct locked_ring
+{
+    bool
+    try_push(int &&v)
+    {
+        std::lock_guard lock(m);
+        if (buf.size() == capacity)
+            return false;
+        buf.push(v);
+        return true;
+    }
+
+    std::size_t
+    try_pop_some(std::span< int > out)
+    {
+        std::lock_guard lock(m);
+        auto            n = std::min(out.size(), buf.size());
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = buf.pop();
+        return n;
+    }
+
+    std::size_t                                       capacity;
+    std::mutex                                        m;
+    asioex::detail::expanding_circular_buffer< int > buf;
+};
+
+TEST_CASE("spsc vs mutex benchmark")
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr int         n        = 5'000'000;
+    constexpr std::size_t capacity = 1024;
+
+    auto run = [&](auto &ring, const char *name)
+    {
+        auto start = clock::now();
+        std::thread producer([&] { produce(ring, n); });
+
+        std::array< int, 64 > out;
+        long                  sum = 0;
+        for (int got = 0; got < n;)
+        {
+            auto k = ring.try_pop_some(out);
+            if (!k)
+                std::this_thread::yield();
+            for (std::size_t i = 0; i < k; ++i)
+                sum += out[i];
+            got += int(k);
+        }
+        producer.join();
+
+        auto s = std::chrono::duration< double >(clock::now() - start).count();
+        std::printf("%s: %.1fM items/s (%ld)\n", name, n / s / 1e6, sum);
+    };
+
+    {
+        asioex::detail::spsc_ring< int > ring { capacity };
+        run(ring, "    spsc_ring");
+    }
+    {
+        locked_ring ring { capacity };
+        run(ring, "mutex + ring");
+    }
+    {
+        asio::io_context ioc;
+        queue_type       q { ioc.get_executor(), capacity };
+
+        auto                  start = clock::now();
+        std::array< int, 64 > out;
+        long                  sum  = 0;
+        auto                  next = [&](auto &self) -> void
+        {
+            q.async_pop_some(out,
+                             [&, self](asio::error_code ec, std::size_t k)
+                             {
+                                 if (ec)
+                                     return;
+                                 for (std::size_t i = 0; i < k; ++i)
+                                     sum += out[i];
+                                 self(self);
+                             });
+        };
+        next(next);
+        std::thread producer(
+            [&]
+            {
+                produce(q, n);
+                q.close();
+            });
+        ioc.run();
+        producer.join();
+
+        auto s = std::chrono::duration< double >(clock::now() - start).count();
+        std::printf("  async queue: %.1fM items/s (%ld)\n", n / s / 1e6, sum);
+    }
+}
+
+TEST_SUITE_END();
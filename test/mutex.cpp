@@ -8,7 +8,15 @@
 #include <asio/use_awaitable.hpp>
 #include <asio/steady_timer.hpp>
 #include <asio/experimental/awaitable_operators.hpp>
-#include "cmake-build-debug/_deps/asio-src/asio/include/asio/detached.hpp"
+#include <asio/io_context.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/post.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <vector>
 
 asio::awaitable<void> main_impl()
 {
@@ -37,10 +45,95 @@ asio::awaitable<void> main_impl()
     assert(seq[6] + 1 == seq[7]);
 }
 
+void test_handoff()
+{
+    asio::io_context ctx;
+    asioex::mutex mtx{ctx.get_executor()};
+    std::vector< int > order;
+
+    // keep the calls under test out of assert, which NDEBUG compiles away
+    bool locked = mtx.try_lock();
+    assert(locked);
+    for (int i = 0; i < 3; ++i)
+        mtx.async_lock([&order, i](asio::error_code ec) { assert(!ec); order.push_back(i); });
+
+    // ownership goes straight to the first waiter, a newcomer cannot barge
+    // the waiters still queued keep the context busy, so poll rather than run
+    mtx.unlock();
+    locked = mtx.try_lock();
+    assert(!locked);
+    ctx.poll();
+    assert(order.size() == 1u);
+    mtx.unlock();
+    ctx.poll();
+    mtx.unlock();
+    ctx.poll();
+    assert((order == std::vector< int >{0, 1, 2}));
+    mtx.unlock();
+    locked = mtx.try_lock();
+    assert(locked);
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+struct contention_stats
+{
+    bench_clock::time_point unlocked_at;
+    bench_clock::duration   handoff_total {};
+    std::size_t             handoffs = 0;
+};
+
+asio::awaitable<void> contender(asioex::mutex &mtx, int n, contention_stats &stats)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        co_await mtx.async_lock(asio::use_awaitable);
+        if (stats.unlocked_at != bench_clock::time_point{})
+        {
+            stats.handoff_total += bench_clock::now() - stats.unlocked_at;
+            stats.handoffs++;
+        }
+        // hold the lock across a scheduler round trip so that others queue
+        co_await asio::post(asio::use_awaitable);
+        stats.unlocked_at = bench_clock::now();
+        mtx.unlock();
+    }
+}
+
+void benchmark_contention(asioex::mutex_mode mode, const char * name)
+{
+    constexpr int contenders = 16;
+    constexpr int locks      = 10000;
+
+    asio::io_context ctx;
+    asioex::mutex mtx{ctx.get_executor(), mode};
+    contention_stats stats;
+
+    for (int i = 0; i < contenders; ++i)
+        asio::co_spawn(ctx, contender(mtx, locks, stats), asio::detached);
+
+    auto start = bench_clock::now();
+    ctx.run();
+    auto total = bench_clock::now() - start;
+
+    std::printf("%s mutex: %lld locks/s, mean handoff latency %lldns\n",
+                name,
+                static_cast< long long >(
+                    contenders * locks / std::chrono::duration< double >(total).count()),
+                static_cast< long long >(
+                    std::chrono::nanoseconds(stats.handoff_total).count() /
+                    static_cast< long long >(stats.handoffs ? stats.handoffs : 1)));
+}
+
 int main(int argc, char * argv[])
 {
+    test_handoff();
+
     asio::io_context ctx;
     asio::co_spawn(ctx, main_impl(), asio::detached);
     ctx.run();
+
+    benchmark_contention(asioex::mutex_mode::handoff, "handoff");
+    benchmark_contention(asioex::mutex_mode::barging, "barging");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asioex/mutex.hpp>
+#include <asioex/shared_mutex.hpp>
+
+#include <asio/bind_cancellation_slot.hpp>
+#include <asio/cancellation_signal.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/use_awaitable.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+void
+test_writer_preference()
+{
+    asio::io_context         ctx;
+    asioex::shared_mutex     mtx { ctx.get_executor() };
+    std::vector< std::string > seq;
+
+    // the calls under test stay out of assert, which NDEBUG compiles away
+    bool locked = mtx.try_lock_shared();
+    assert(locked);
+    locked = mtx.try_lock_shared();
+    assert(locked);
+    locked = mtx.try_lock();
+    assert(!locked);
+
+    mtx.async_lock([&](asio::error_code ec) { assert(!ec); seq.push_back("w"); });
+
+    // a queued writer holds back new readers
+    locked = mtx.try_lock_shared();
+    assert(!locked);
+    mtx.async_lock_shared([&](asio::error_code ec) { assert(!ec); seq.push_back("r"); });
+
+    // the queued waiters keep the context busy, so poll rather than run
+    mtx.unlock_shared();
+    ctx.poll();
+    assert(seq.empty());
+
+    mtx.unlock_shared();
+    ctx.poll();
+    assert((seq == std::vector< std::string > { "w" }));
+
+    // downgrading lets the queued reader in alongside
+    mtx.unlock_and_lock_shared();
+    ctx.restart();
+    ctx.run();
+    assert((seq == std::vector< std::string > { "w", "r" }));
+    assert(mtx.shared_count() == 2);
+    mtx.unlock_shared();
+    mtx.unlock_shared();
+    locked = mtx.try_lock();
+    assert(locked);
+    mtx.unlock();
+}
+
+void
+test_upgrade()
+{
+    asio::io_context     ctx;
+    asioex::shared_mutex mtx { ctx.get_executor() };
+
+    bool locked = mtx.try_lock_upgrade();
+    assert(locked);
+    locked = mtx.try_lock_upgrade();
+    assert(!locked);
+    locked = mtx.try_lock();
+    assert(!locked);
+    locked = mtx.try_lock_shared();
+    assert(locked);
+
+    bool upgraded = false;
+    mtx.async_upgrade([&](asio::error_code ec) { assert(!ec); upgraded = true; });
+
+    // the pending upgrade waits for the reader and keeps new ones out
+    locked = mtx.try_lock_shared();
+    assert(!locked);
+    ctx.poll();
+    assert(!upgraded);
+
+    mtx.unlock_shared();
+    ctx.restart();
+    ctx.run();
+    assert(upgraded);
+    locked = mtx.try_lock_shared();
+    assert(!locked);
+    locked = mtx.try_lock_upgrade();
+    assert(!locked);
+    mtx.unlock();
+    locked = mtx.try_lock_upgrade();
+    assert(locked);
+    mtx.unlock_upgrade();
+}
+
+void
+test_cancel_writer()
+{
+    asio::io_context          ctx;
+    asioex::shared_mutex      mtx { ctx.get_executor() };
+    asio::cancellation_signal sig;
+    asio::error_code          writer_ec;
+    bool                      reader_done = false;
+
+    bool locked = mtx.try_lock_shared();
+    assert(locked);
+    mtx.async_lock(asio::bind_cancellation_slot(
+        sig.slot(), [&](asio::error_code ec) { writer_ec = ec; }));
+    mtx.async_lock_shared([&](asio::error_code ec) { assert(!ec); reader_done = true; });
+
+    // with the writer gone the reader is no longer held back
+    sig.emit(asio::cancellation_type::all);
+    ctx.run();
+    assert(writer_ec == asio::error::operation_aborted);
+    assert(reader_done);
+    assert(mtx.shared_count() == 2);
+}
+
+void
+test_guard_and_destruction()
+{
+    asio::io_context ctx;
+    int              aborted = 0;
+    {
+        asioex::shared_mutex mtx { ctx.get_executor() };
+        bool                 guarded = false;
+        asioex::async_shared_guard(
+            mtx,
+            [&](asio::error_code ec, asioex::shared_lock_guard)
+            {
+                assert(!ec);
+                assert(mtx.shared_count() == 1);
+                guarded = true;
+            });
+        ctx.run();
+        assert(guarded);
+        assert(mtx.shared_count() == 0);
+
+        bool locked = mtx.try_lock();
+        assert(locked);
+        for (int i = 0; i < 3; ++i)
+            mtx.async_lock_shared([&](asio::error_code ec) { if (ec) ++aborted; });
+        mtx.async_lock([&](asio::error_code ec) { if (ec) ++aborted; });
+    }
+    ctx.restart();
+    ctx.run();
+    assert(aborted == 4);
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+constexpr int bench_tasks = 16;
+constexpr int bench_ops   = 10000;
+
+// one operation in ten writes
+asio::awaitable< void >
+shared_worker(asioex::shared_mutex &mtx, int id)
+{
+    for (int i = 0; i < bench_ops; ++i)
+    {
+        bool write = (i + id) % 10 == 0;
+        if (write)
+            co_await mtx.async_lock(asio::use_awaitable);
+        else
+            co_await mtx.async_lock_shared(asio::use_awaitable);
+        // hold the lock across a scheduler round trip so that others queue
+        co_await asio::post(asio::use_awaitable);
+        if (write)
+            mtx.unlock();
+        else
+            mtx.unlock_shared();
+    }
+}
+
+asio::awaitable< void >
+exclusive_worker(asioex::mutex &mtx)
+{
+    for (int i = 0; i < bench_ops; ++i)
+    {
+        co_await mtx.async_lock(asio::use_awaitable);
+        co_await asio::post(asio::use_awaitable);
+        mtx.unlock();
+    }
+}
+
+template < class Mutex, class Worker >
+void
+run_read_heavy(const char *name, Worker worker)
+{
+    asio::io_context ctx;
+    Mutex            mtx { ctx.get_executor() };
+    for (int i = 0; i < bench_tasks; ++i)
+        asio::co_spawn(ctx, worker(mtx, i), asio::detached);
+
+    auto start = bench_clock::now();
+    ctx.run();
+    auto total = bench_clock::now() - start;
+    std::printf("%s: %lld locks/s\n",
+                name,
+                static_cast< long long >(
+                    bench_tasks * bench_ops /
+                    std::chrono::duration< double >(total).count()));
+}
+
+void
+benchmark_read_heavy()
+{
+    run_read_heavy< asioex::shared_mutex >(
+        "shared_mutex 90% reads",
+        [](asioex::shared_mutex &mtx, int id) { return shared_worker(mtx, id); });
+    run_read_heavy< asioex::mutex >(
+        "mutex baseline",
+        [](asioex::mutex &mtx, int) { return exclusive_worker(mtx); });
+}
+
+int
+main()
+{
+    test_writer_preference();
+    test_upgrade();
+    test_cancel_writer();
+    test_guard_and_destruction();
+    benchmark_read_heavy();
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Copyright (c) 2021 Klemens D. Morgenstern
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <asio.hpp>
+#include <asioex/copy.hpp>
+#include <asioex/splice_copy.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+#include <unistd.h>
+#endif
+
+#define check_eq(x, y) \
+    if (x != y) \
+    {                  \
+        std::cerr << __FILE__ "(" << __LINE__ << ") '" #x " != " #y "' failed: " << x << " != " << y << std::endl;               \
+        errors ++; \
+    }                  \
+
+using asio::ip::tcp;
+
+// The relay copies from `in` to `out`. A writer thread sends `total` bytes
+// into `in` and a reader counts what comes out of `out`, so that only the
+// relay runs on the thread that is measured.
+struct loopback
+{
+    asio::io_context relay_ctx, ends_ctx;
+    tcp::socket writer{ends_ctx}, in{relay_ctx}, out{relay_ctx}, reader{ends_ctx};
+
+    loopback()
+    {
+        tcp::acceptor acceptor{ends_ctx, {asio::ip::address_v4::loopback(), 0}};
+        writer.connect(acceptor.local_endpoint());
+        acceptor.accept(in);
+        out.connect(acceptor.local_endpoint());
+        acceptor.accept(reader);
+    }
+
+    struct result
+    {
+        asio::error_code ec;
+        std::size_t copied = 0u;
+        std::size_t received = 0u;
+        bool intact = true;
+        double seconds = 0.;
+        double cpu_seconds = 0.; // only measured on Linux
+    };
+
+    template<typename Copy>
+    result run(std::size_t total, bool verify, Copy copy)
+    {
+        result res;
+        std::vector<unsigned char> wbuf(65536), rbuf(65536);
+        std::size_t written = 0u;
+
+        auto write = [&](auto & self) -> void
+        {
+            if (written == total)
+                return writer.shutdown(tcp::socket::shutdown_send);
+            auto n = (std::min)(wbuf.size(), total - written);
+            if (verify)
+                for (std::size_t i = 0; i < n; i++)
+                    wbuf[i] = static_cast<unsigned char>((written + i) % 251);
+            asio::async_write(writer, asio::buffer(wbuf.data(), n),
+                              [&](asio::error_code ec, std::size_t n)
+                              {
+                                  written += n;
+                                  if (!ec)
+                                      self(self);
+                              });
+        };
+        auto read = [&](auto & self) -> void
+        {
+            reader.async_read_some(asio::buffer(rbuf),
+                                   [&](asio::error_code ec, std::size_t n)
+                                   {
+                                       if (verify)
+                                           for (std::size_t i = 0; i < n; i++)
+                                               res.intact &= rbuf[i] == (res.received + i) % 251;
+                                       res.received += n;
+                                       if (!ec)
+                                           self(self);
+                                   });
+        };
+        write(write);
+        read(read);
+        std::thread ends{[&]{ ends_ctx.run(); }};
+
+#if defined(__linux__)
+        timespec cpu0, cpu1;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu0);
+#endif
+        auto start = std::chrono::steady_clock::now();
+        copy(in, out, [&](asio::error_code ec, std::size_t n)
+        {
+            res.ec = ec;
+            res.copied = n;
+            out.shutdown(tcp::socket::shutdown_send);
+        });
+        relay_ctx.run();
+        res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#if defined(__linux__)
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu1);
+        res.cpu_seconds = double(cpu1.tv_sec - cpu0.tv_sec) + double(cpu1.tv_nsec - cpu0.tv_nsec) / 1e9;
+#endif
+
+        ends.join();
+        return res;
+    }
+};
+
+auto spliced = [](tcp::socket & in, tcp::socket & out, auto handler)
+{
+    asioex::async_splice_copy(in, out, std::move(handler));
+};
+
+// what a relay does without async_splice_copy
+auto buffered = [](tcp::socket & in, tcp::socket & out, auto handler)
+{
+    auto buf = std::make_shared<std::vector<char>>(65536);
+    auto bytes = std::make_shared<std::size_t>(0u);
+    asioex::async_copy(
+            [&in, buf](auto && h) { in.async_read_some(asio::buffer(*buf), std::move(h)); },
+            [&out, buf, bytes](std::size_t n, auto && h)
+            {
+                *bytes += n;
+                asio::async_write(out, asio::buffer(buf->data(), n), std::move(h));
+            },
+            [bytes, handler = std::move(handler)](asio::error_code ec, std::size_t) mutable
+            {
+                std::move(handler)(ec, *bytes);
+            });
+};
+
+int
+main()
+{
+    int errors = 0;
+
+    constexpr std::size_t small = 8u << 20;
+    {
+        auto res = loopback{}.run(small, true, spliced);
+        check_eq(res.ec, asio::error::eof);
+        check_eq(res.copied, small);
+        check_eq(res.received, small);
+        check_eq(res.intact, true);
+    }
+    {
+        auto res = loopback{}.run(small, true, buffered);
+        check_eq(res.ec, asio::error::eof);
+        check_eq(res.received, small);
+        check_eq(res.intact, true);
+    }
+
+    // a setup error still completes from the event loop
+    {
+        asio::io_context ctx;
+        tcp::socket in{ctx}, out{ctx};
+        asio::error_code ec;
+        bool done = false;
+        asioex::async_splice_copy(in, out, [&](asio::error_code ec_, std::size_t) { ec = ec_; done = true; });
+        check_eq(done, false);
+        ctx.run();
+        check_eq(done, true);
+        check_eq(ec, asio::error::bad_descriptor);
+    }
+
+#if defined(ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+    // streams which are not sockets are copied through a buffer
+    {
+        asio::io_context ctx;
+        int a[2], b[2];
+        if (::pipe(a) != 0 || ::pipe(b) != 0)
+            return 1;
+        asio::posix::stream_descriptor writer{ctx, a[1]}, in{ctx, a[0]}, out{ctx, b[1]}, reader{ctx, b[0]};
+
+        constexpr std::size_t total = 1u << 20;
+        std::vector<unsigned char> wbuf(total), rbuf(65536);
+        for (std::size_t i = 0; i < total; i++)
+            wbuf[i] = static_cast<unsigned char>(i % 251);
+        asio::async_write(writer, asio::buffer(wbuf), [&](asio::error_code, std::size_t) { writer.close(); });
+
+        std::size_t received = 0u;
+        bool intact = true;
+        auto read = [&](auto & self) -> void
+        {
+            reader.async_read_some(asio::buffer(rbuf),
+                                   [&](asio::error_code ec, std::size_t n)
+                                   {
+                                       for (std::size_t i = 0; i < n; i++)
+                                           intact &= rbuf[i] == (received + i) % 251;
+                                       received += n;
+                                       if (!ec)
+                                           self(self);
+                                   });
+        };
+        read(read);
+
+        asio::error_code ec;
+        std::size_t copied = 0u;
+        asioex::async_splice_copy(in, out, [&](asio::error_code ec_, std::size_t n)
+        {
+            ec = ec_;
+            copied = n;
+            out.close();
+        });
+        ctx.run();
+        check_eq(ec, asio::error::eof);
+        check_eq(copied, total);
+        check_eq(received, total);
+        check_eq(intact, true);
+    }
+#endif
+
+    constexpr std::size_t large = 1u << 30;
+    auto report = [](const char * name, loopback::result const & res)
+    {
+        std::cout << name << ": " << res.copied / res.seconds / 1e9 << " GB/s";
+#if defined(__linux__)
+        std::cout << ", relay cpu " << 100. * res.cpu_seconds / res.seconds << "%";
+#endif
+        std::cout << std::endl;
+    };
+    report("  splice", loopback{}.run(large, false, spliced));
+    report("buffered", loopback{}.run(large, false, buffered));
+
+    return errors;
+}
@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2021 Richard Hodges (hodges.r@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/madmongo1/asio_experiments
+//
+
+#include <asio.hpp>
+
+#include <asioex/async_semaphore.hpp>
+#include <asioex/condition_variable.hpp>
+#include <asioex/mutex.hpp>
+#include <asioex/sync_stats.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <type_traits>
+
+using namespace asioex;
+
+#define check_eq(X, Y)                                                         \
+    if ((X) != (Y))                                                            \
+    {                                                                          \
+        printf(#X " == " #Y " failed: %lld != %lld\n",                         \
+               static_cast< long long >(X),                                    \
+               static_cast< long long >(Y));                                   \
+        errors++;                                                              \
+    }
+
+// The disabled policy must cost nothing. A primitive's code is a function of
+// its type, its layout and the types of the wait ops it instantiates, so it is
+// enough to show that with null_sync_stats all three are what they would be
+// without statistics support.
+
+using executor = asio::io_context::executor_type;
+
+// the default primitives are the null policy instantiations
+static_assert(std::is_same_v<
+              async_semaphore,
+              basic_async_semaphore< asio::any_io_executor,
+                                     fifo_wait_queue,
+                                     null_sync_stats > >);
+static_assert(
+    std::is_same_v< mutex, basic_mutex< asio::any_io_executor, null_sync_stats > >);
+static_assert(std::is_same_v<
+              condition_variable,
+              basic_condition_variable< asio::any_io_executor, null_sync_stats > >);
+
+// parked handlers are not wrapped, so the wait op types are unchanged
+struct some_handler
+{
+    void operator()(error_code) {}
+};
+static_assert(
+    std::is_same_v< decltype(std::declval< null_sync_stats & >().on_park(
+                        0, std::declval< some_handler >())),
+                    some_handler && >);
+static_assert(
+    std::is_same_v< decltype(std::declval< null_sync_stats & >().on_park(
+                        0, std::declval< some_handler & >())),
+                    some_handler & >);
+
+// and the policy takes no space
+struct semaphore_without_stats : async_semaphore_base
+{
+    executor exec_;
+};
+static_assert(sizeof(basic_async_semaphore< executor >) ==
+              sizeof(semaphore_without_stats));
+
+struct mutex_without_stats
+{
+    mutex_mode                        mode_;
+    bool                              locked_;
+    basic_async_semaphore< executor > semaphore_;
+};
+static_assert(sizeof(basic_mutex< executor >) == sizeof(mutex_without_stats));
+
+struct condition_variable_without_stats : condition_variable_base
+{
+    executor exec_;
+};
+static_assert(sizeof(basic_condition_variable< executor >) ==
+              sizeof(condition_variable_without_stats));
+
+int
+test_histogram()
+{
+    int errors = 0;
+
+    using h = wait_time_histogram;
+    for (std::size_t i = 0; i < h::bucket_count; ++i)
+        check_eq(h::bucket_of(h::lower_bound(i)), i);
+    check_eq(h::bucket_of(5), h::bucket_of(5));
+    check_eq(h::bucket_of(1000), h::bucket_of(1023));
+    check_eq(h::bucket_of(1024) == h::bucket_of(1023), false);
+    check_eq(h::bucket_of(~std::uint64_t(0)), h::bucket_count - 1);
+
+    h hist;
+    hist.counts[h::bucket_of(10)]   = 98;
+    hist.counts[h::bucket_of(5000)] = 2;
+    check_eq(hist.total(), 100);
+    check_eq(hist.percentile(0.5), h::lower_bound(h::bucket_of(10)));
+    check_eq(hist.percentile(0.99), h::lower_bound(h::bucket_of(5000)));
+    check_eq(h().percentile(0.5), 0);
+
+    return errors;
+}
+
+int
+test_semaphore()
+{
+    int errors = 0;
+
+    asio::io_context                                           ioc;
+    basic_async_semaphore< executor, fifo_wait_queue, sync_stats > sem {
+        ioc.get_executor(), 1
+    };
+
+    asio::cancellation_signal sig;
+    int                       done = 0;
+    auto                      on   = [&](error_code) { ++done; };
+
+    sem.async_acquire(on);
+    sem.async_acquire(on);
+    sem.async_acquire(asio::bind_cancellation_slot(sig.slot(), on));
+    sem.async_acquire(on);
+    check_eq(sem.stats().max_queue_depth, 3);
+
+    // the fourth acquire is still parked and keeps the context busy
+    sig.emit(asio::cancellation_type::terminal);
+    sem.release();
+    ioc.poll();
+    check_eq(done, 3);
+
+    sem.release_all();
+    ioc.restart();
+    ioc.run();
+
+    // a deadline which has already passed times out without parking
+    sem.async_acquire_until(std::chrono::steady_clock::now() -
+                                std::chrono::seconds(1),
+                            on);
+    ioc.restart();
+    ioc.run();
+    check_eq(done, 5);
+
+    auto s = sem.stats();
+    check_eq(s.acquires, 5);
+    check_eq(s.fast_path, 1);
+    check_eq(s.parks, 3);
+    check_eq(s.acquires, s.fast_path + s.parks + 1);
+    check_eq(s.cancellations, 1);
+    check_eq(s.timeouts, 1);
+    check_eq(s.max_queue_depth, 3);
+    check_eq(s.wait_time.total(), 3);
+
+    return errors;
+}
+
+int
+test_mutex(mutex_mode mode)
+{
+    int errors = 0;
+
+    asio::io_context                   ioc;
+    basic_mutex< executor, sync_stats > mtx { ioc.get_executor(), mode };
+
+    int locked = 0;
+    mtx.async_lock([&](error_code ec) { locked += !ec; });
+    ioc.run();
+    mtx.async_lock([&](error_code ec) { locked += !ec; });
+    mtx.async_lock([&](error_code ec) { locked += !ec; });
+    check_eq(mtx.stats().max_queue_depth, 2);
+
+    // a queued lock keeps the context busy, so poll rather than run
+    mtx.unlock();
+    ioc.restart();
+    ioc.poll();
+    mtx.unlock();
+    ioc.poll();
+    mtx.unlock();
+    check_eq(locked, 3);
+
+    auto s = mtx.stats();
+    check_eq(s.acquires, 3);
+    check_eq(s.fast_path, 1);
+    check_eq(s.parks, 2);
+    check_eq(s.wait_time.total(), 2);
+
+    return errors;
+}
+
+int
+test_barging_requeue()
+{
+    int errors = 0;
+
+    asio::io_context                   ioc;
+    basic_mutex< executor, sync_stats > mtx { ioc.get_executor(),
+                                             mutex_mode::barging };
+
+    int locked = 0;
+    check_eq(mtx.try_lock(), true);
+    mtx.async_lock([&](error_code ec) { locked += !ec; });
+
+    // the woken waiter finds the mutex taken by a newcomer and parks again
+    mtx.unlock();
+    check_eq(mtx.try_lock(), true);
+    ioc.poll();
+    check_eq(locked, 0);
+
+    mtx.unlock();
+    ioc.poll();
+    check_eq(locked, 1);
+    mtx.unlock();
+
+    // the second park continues the same wait
+    auto s = mtx.stats();
+    check_eq(s.acquires, 1);
+    check_eq(s.parks, 1);
+    check_eq(s.max_queue_depth, 1);
+    check_eq(s.wait_time.total(), 1);
+
+    return errors;
+}
+
+int
+test_condition_variable()
+{
+    int errors = 0;
+
+    asio::io_context                                ioc;
+    basic_condition_variable< executor, sync_stats > cv { ioc.get_executor() };
+
+    bool ready = false;
+    int  woken = 0;
+    cv.async_wait([&] { return true; }, [&](error_code) { ++woken; });
+    cv.async_wait([&] { return ready; }, [&](error_code) { ++woken; });
+    cv.async_wait([&](error_code) { ++woken; });
+    check_eq(cv.stats().max_queue_depth, 2);
+
+    cv.notify_all();
+    ready = true;
+    cv.notify_all();
+    ioc.run();
+    check_eq(woken, 3);
+
+    auto s = cv.stats();
+    check_eq(s.acquires, 3);
+    check_eq(s.fast_path, 1);
+    check_eq(s.parks, 2);
+    check_eq(s.wait_time.total(), 2);
+
+    return errors;
+}
+
+int
+main()
+{
+    int res = 0;
+    res += test_histogram();
+    res += test_semaphore();
+    res += test_mutex(mutex_mode::handoff);
+    res += test_mutex(mutex_mode::barging);
+    res += test_barging_requeue();
+    res += test_condition_variable();
+    return res;
+}